@@ -33,6 +33,8 @@
 #include "Galois/Graph/TypeTraits.h"
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
+#include "Lonestar/SchedulerOptions.h"
+#include "Lonestar/DecreaseKeyIndexer.h"
 
 #include <iostream>
 #include <deque>
@@ -72,7 +74,6 @@ static cll::opt<std::string> filename(cll::Positional, cll::desc("<input graph>"
 static cll::opt<std::string> coordFilename("coordFilename", cll::desc("coordinate file name"));
 static cll::opt<unsigned int> xdim("xdim", cll::desc("xdim of the map"));
 static cll::opt<unsigned int> ydim("ydim", cll::desc("ydim of the map"));
-static cll::opt<std::string> mqSuff("suff", cll::desc("Suffix for amq or smq"), cll::init(""));
 
 static cll::opt<std::string> transposeGraphName("graphTranspose", cll::desc("Transpose of input graph"));
 static cll::opt<bool> symmetricGraph("symmetricGraph", cll::desc("Input graph is symmetric"));
@@ -629,9 +630,9 @@ struct AsyncAlgo {
     typedef UpdateRequestComparer<UpdateRequest> Comparer;
     typedef UpdateRequestNodeComparer<UpdateRequest> NodeComparer;
     typedef UpdateRequestHasher<UpdateRequest> Hasher;
-    typedef GlobPQ<UpdateRequest, kLSMQ<UpdateRequest, UpdateRequestIndexer<UpdateRequest>, 256>> kLSM256;
-    typedef GlobPQ<UpdateRequest, kLSMQ<UpdateRequest, UpdateRequestIndexer<UpdateRequest>, 16384>> kLSM16k;
-    typedef GlobPQ<UpdateRequest, kLSMQ<UpdateRequest, UpdateRequestIndexer<UpdateRequest>, 4194304>> kLSM4m;
+    typedef KLSM<UpdateRequest, UpdateRequestIndexer<UpdateRequest>, 256> kLSM256;
+    typedef KLSM<UpdateRequest, UpdateRequestIndexer<UpdateRequest>, 16384> kLSM16k;
+    typedef KLSM<UpdateRequest, UpdateRequestIndexer<UpdateRequest>, 4194304> kLSM4m;
     typedef GlobPQ<UpdateRequest, LockFreeSkipList<Comparer, UpdateRequest>> GPQ;
     typedef GlobPQ<UpdateRequest, SprayList<NodeComparer, UpdateRequest>> SL;
     typedef GlobPQ<UpdateRequest, MultiQueue<Comparer, UpdateRequest, 1>> MQ1;
@@ -675,7 +676,12 @@ struct AsyncAlgo {
       mqSuff = "_" + mqSuff;
     }
 
-#define RUN_WL(WL) Galois::for_each_local(initial, Process(this, graph), Galois::wl<WL>())
+#define RUN_WL(WL) do { \
+      if (relaxationStats) \
+        Galois::for_each_local(initial, Process(this, graph), Galois::wl<RelaxationQuality<WL, Comparer>>()); \
+      else \
+        Galois::for_each_local(initial, Process(this, graph), Galois::wl<WL>()); \
+    } while (0)
 
 #define priority_t Dist
 #define element_t UpdateRequest
@@ -770,6 +776,22 @@ struct AsyncAlgo {
 
     typedef StealingMultiQueue<element_t, Comparer, 8, 8, true> smq_default;
     if (wl == "smq_default") RUN_WL(smq_default);
+    typedef RuntimeStealingMultiQueue<element_t, Comparer, true> smq;
+    if (wl == "smq") RUN_WL(smq);
+    typedef PackedStealingMultiQueue<element_t, Comparer, Dist, 8, true> smqpacked;
+    if (wl == "smqpacked") RUN_WL(smqpacked);
+    typedef DecreaseKeyStealingMultiQueue<element_t, Comparer, DecreaseKeyIndexer<element_t>, true> smqdk;
+    if (wl == "smqdk") RUN_WL(smqdk);
+    typedef AdaptiveStealingMultiQueue<element_t, Comparer, true> asmq;
+    if (wl == "asmq") RUN_WL(asmq);
+    typedef StealingMultiQueueNuma<element_t, Comparer, 0, 0, 0, true> smqnuma;
+    if (wl == "smqnuma") RUN_WL(smqnuma);
+    typedef RuntimePolicyMultiQueue<element_t, Comparer> policymq;
+    if (wl == "policymq") RUN_WL(policymq);
+    typedef RuntimePolicyMultiQueueNuma<element_t, Comparer> policymqnuma;
+    if (wl == "policymqnuma") RUN_WL(policymqnuma);
+    typedef KLSM<element_t, UpdateRequestIndexer<UpdateRequest>> klsm;
+    if (wl == "klsm") RUN_WL(klsm);
 
 
   }
@@ -962,6 +984,7 @@ uint64_t getStatVal(Galois::Statistic* value) {
 int main(int argc, char **argv) {
   Galois::StatManager statManager;
   LonestarStart(argc, argv, name, desc, url);
+  applySchedulerOptions();
 
   if (trackWork) {
     BadWork = new Galois::Statistic("BadWork");
@@ -996,6 +1019,25 @@ int main(int argc, char **argv) {
 
   if (trackWork) {
     std::string wl = worklistname;
+    if (wl == "smq")
+      wl = "smqhm_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch);
+    if (wl == "smqpacked")
+      wl = "smqpackedhm_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch);
+    if (wl == "smqdk")
+      wl = "smqdkhm_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch);
+    if (wl == "smqnuma")
+      wl = "smqhmnuma_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch)
+         + "_" + std::to_string(numaWeight);
+    if (wl == "policymq" || wl == "policymqnuma") {
+      // Named as the heatmaps of the policies: r -- random or two-choice,
+      // p -- temporal, l -- batching.
+      const char letters[] = "rpl";
+      const bool numa = wl == "policymqnuma";
+      wl = std::string("mq") + letters[mqInsert] + letters[mqDelete] + (numa ? "numa_" : "_")
+         + std::to_string(mqC) + "_" + std::to_string(mqInsertParam) + "_" + std::to_string(mqDeleteParam);
+      if (numa)
+        wl += "_" + std::to_string(numaWeight);
+    }
     if (wl.find("smq") == 0)
       wl = wl + mqSuff;
     std::ofstream nodes(resultFileName + mqSuff, std::ios::app);
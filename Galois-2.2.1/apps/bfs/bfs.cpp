@@ -38,6 +38,7 @@
 #endif
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
+#include "Lonestar/SchedulerOptions.h"
 
 #include <string>
 #include <deque>
@@ -90,7 +91,6 @@ namespace cll = llvm::cl;
 static cll::opt<std::string> filename(cll::Positional, cll::desc("<input graph>"), cll::Required);
 static cll::opt<std::string> transposeGraphName("graphTranspose", cll::desc("Transpose of input graph"));
 static cll::opt<std::string> resultFile("resultFile", cll::desc("Result file name for amq experiment"), cll::init("result.csv"));
-static cll::opt<std::string> mqSuff("suff", cll::desc("Suffix for amq or smq"), cll::init(""));
 static cll::opt<bool> symmetricGraph("symmetricGraph", cll::desc("Input graph is symmetric"));
 static cll::opt<bool> useDetBase("detBase", cll::desc("Deterministic"));
 static cll::opt<bool> useDetDisjoint("detDisjoint", cll::desc("Deterministic with disjoint optimization"));
@@ -478,7 +478,12 @@ struct AsyncAlgo {
     graph.getData(source).dist = 0;
     std::string wl = worklistname;
 
-#define RUN_WL(WL) Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<WL>())
+#define RUN_WL(WL) do { \
+      if (relaxationStats) \
+        Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<RelaxationQuality<WL, Comparer>>()); \
+      else \
+        Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<WL>()); \
+    } while (0)
 #define element_t WorkItem
 #define priority_t Dist
 #include "Experiments.h"
@@ -581,6 +586,18 @@ struct AsyncAlgo {
 
     typedef StealingMultiQueue<element_t, Comparer, 8, 8, true> smq_default;
     if (wl == "smq_default") RUN_WL(smq_default);
+    typedef RuntimeStealingMultiQueue<element_t, Comparer, true> smq;
+    if (wl == "smq") RUN_WL(smq);
+    typedef AdaptiveStealingMultiQueue<element_t, Comparer, true> asmq;
+    if (wl == "asmq") RUN_WL(asmq);
+    typedef StealingMultiQueueNuma<element_t, Comparer, 0, 0, 0, true> smqnuma;
+    if (wl == "smqnuma") RUN_WL(smqnuma);
+    typedef RuntimePolicyMultiQueue<element_t, Comparer> policymq;
+    if (wl == "policymq") RUN_WL(policymq);
+    typedef RuntimePolicyMultiQueueNuma<element_t, Comparer> policymqnuma;
+    if (wl == "policymqnuma") RUN_WL(policymqnuma);
+    typedef KLSM<element_t, Indexer> klsm;
+    if (wl == "klsm") RUN_WL(klsm);
   }
 };
 
@@ -955,6 +972,7 @@ uint64_t getStatVal(Galois::Statistic* value) {
 int main(int argc, char **argv) {
   Galois::StatManager statManager;
   LonestarStart(argc, argv, name, desc, url);
+  applySchedulerOptions();
 
   if (trackWork) {
     BadWork = new Galois::Statistic("BadWork");
@@ -1002,6 +1020,21 @@ int main(int argc, char **argv) {
 
   if (trackWork) {
     std::string wl = worklistname;
+    if (wl == "smq")
+      wl = "smqhm_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch);
+    if (wl == "smqnuma")
+      wl = "smqhmnuma_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch)
+         + "_" + std::to_string(numaWeight);
+    if (wl == "policymq" || wl == "policymqnuma") {
+      // Named as the heatmaps of the policies: r -- random or two-choice,
+      // p -- temporal, l -- batching.
+      const char letters[] = "rpl";
+      const bool numa = wl == "policymqnuma";
+      wl = std::string("mq") + letters[mqInsert] + letters[mqDelete] + (numa ? "numa_" : "_")
+         + std::to_string(mqC) + "_" + std::to_string(mqInsertParam) + "_" + std::to_string(mqDeleteParam);
+      if (numa)
+        wl += "_" + std::to_string(numaWeight);
+    }
     if (wl.find("smq") == 0)
       wl = wl + mqSuff;
     std::ofstream nodes(resultFile + mqSuff, std::ios::app);
@@ -30,6 +30,7 @@
 
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
+#include "Lonestar/SchedulerOptions.h"
 #ifdef GALOIS_USE_EXP
 #include "Galois/PriorityScheduling.h"
 #endif
@@ -67,7 +68,6 @@ static cll::opt<bool> verify_via_kruskal("verify",cll::desc("Verify MST result v
 static cll::opt<int> stepShift("delta", cll::desc("Shift value for the deltastep"), cll::init(0));
 static cll::opt<std::string> worklistname("wl", cll::desc("Worklist to use"), cll::value_desc("worklist"), cll::init("obim"));
 static cll::opt<std::string> resultFile("resultFile", cll::desc("File for writting experiment results"), cll::init("result.txt"));
-static cll::opt<std::string> mqSuff("suff", cll::desc("Suffix for amq or smq"), cll::init(""));
 
 
 static const bool trackWork = true;
@@ -208,6 +208,32 @@ struct WorkItem{
   }
 };
 
+//! WorkItem of smqpacked, ordered as seq_gt: the degree, then the node.
+//! The lower level keeps the low bits of the node address without its
+//! alignment bits, which order the nodes within any 16 GB.
+struct KeyedWorkItem: public WorkItem {
+  typedef Galois::WorkList::LexicographicKey<32, 31> Key;
+
+  KeyedWorkItem() {}
+
+  KeyedWorkItem(const WorkItem& item): WorkItem(item) {}
+
+  Key::type key() const {
+    return Key::pack(second, (reinterpret_cast<uintptr_t>(first) >> 3) & Key::maxOf(1));
+  }
+};
+
+namespace Galois {
+namespace WorkList {
+template<>
+struct PriorityTraits<KeyedWorkItem> {
+  static KeyedWorkItem::Key::type prior(KeyedWorkItem const& item) {
+    return item.key();
+  }
+};
+} // namespace WorkList
+} // namespace Galois
+
 struct Indexer: public std::unary_function<WorkItem, unsigned> {
    unsigned operator()(const WorkItem& n) {
       unsigned t = stepShift ? (n.second >> stepShift) : n.second;
@@ -351,6 +377,12 @@ struct UpdateRequestComparer: public std::binary_function<const UpdateRequest&,
   }
 };
 
+struct KeyComparer: public std::binary_function<const KeyedWorkItem&, const KeyedWorkItem&, bool> {
+  bool operator()(const KeyedWorkItem& x, const KeyedWorkItem& y) const {
+    return x.key() > y.key();
+  }
+};
+
 //End body of for-each.
 ///////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -436,7 +468,12 @@ long long runBodyParallel() {
    T.start();
 
 #define element_t UpdateRequest
-#define RUN_WL(WL) Galois::for_each_local(initial, process(), Galois::wl<WL>())
+#define RUN_WL(WL) do { \
+      if (relaxationStats) \
+        Galois::for_each_local(initial, process(), Galois::wl<RelaxationQuality<WL, Comparer>>()); \
+      else \
+        Galois::for_each_local(initial, process(), Galois::wl<WL>()); \
+    } while (0)
 #include "Experiments.h"
 #ifdef GALOIS_USE_EXP
    Exp::PriAuto<64, Indexer, OBIM, seq_less, seq_gt>::for_each_local(graph.begin(), graph.end(), process());
@@ -523,6 +560,26 @@ long long runBodyParallel() {
 
   typedef StealingMultiQueue<element_t, Comparer, 8, 8, true> smq_default;
   if (wl == "smq_default") RUN_WL(smq_default);
+  typedef RuntimeStealingMultiQueue<element_t, Comparer, true> smq;
+  if (wl == "smq") RUN_WL(smq);
+  typedef PackedStealingMultiQueue<KeyedWorkItem, KeyComparer, KeyedWorkItem::Key::type, 8, true> smqpacked;
+  if (wl == "smqpacked") {
+    Galois::InsertBag<KeyedWorkItem> keyed;
+    for (const WorkItem& item : initial)
+      keyed.push(item);
+    if (relaxationStats)
+      Galois::for_each_local(keyed, process(), Galois::wl<RelaxationQuality<smqpacked, KeyComparer>>());
+    else
+      Galois::for_each_local(keyed, process(), Galois::wl<smqpacked>());
+  }
+  typedef AdaptiveStealingMultiQueue<element_t, Comparer, true> asmq;
+  if (wl == "asmq") RUN_WL(asmq);
+  typedef StealingMultiQueueNuma<element_t, Comparer, 0, 0, 0, true> smqnuma;
+  if (wl == "smqnuma") RUN_WL(smqnuma);
+  typedef RuntimePolicyMultiQueue<element_t, Comparer> policymq;
+  if (wl == "policymq") RUN_WL(policymq);
+  typedef RuntimePolicyMultiQueueNuma<element_t, Comparer> policymqnuma;
+  if (wl == "policymqnuma") RUN_WL(policymqnuma);
 
 #endif
    T.stop();
@@ -742,6 +799,7 @@ uint64_t getStatVal(Galois::Statistic* value) {
 int main(int argc, char **argv) {
    Galois::StatManager M;
    LonestarStart(argc, argv, name, desc, url);
+   applySchedulerOptions();
    if(use_weighted_rmat)
       readWeightedRMAT(inputfile.c_str());
    else
@@ -775,6 +833,23 @@ int main(int argc, char **argv) {
 
    if (trackWork) {
      std::string wl = worklistname;
+     if (wl == "smq")
+       wl = "smqhm_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch);
+     if (wl == "smqpacked")
+       wl = "smqpackedhm_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch);
+     if (wl == "smqnuma")
+       wl = "smqhmnuma_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch)
+          + "_" + std::to_string(numaWeight);
+     if (wl == "policymq" || wl == "policymqnuma") {
+       // Named as the heatmaps of the policies: r -- random or two-choice,
+       // p -- temporal, l -- batching.
+       const char letters[] = "rpl";
+       const bool numa = wl == "policymqnuma";
+       wl = std::string("mq") + letters[mqInsert] + letters[mqDelete] + (numa ? "numa_" : "_")
+          + std::to_string(mqC) + "_" + std::to_string(mqInsertParam) + "_" + std::to_string(mqDeleteParam);
+       if (numa)
+         wl += "_" + std::to_string(numaWeight);
+     }
      if (wl.find("smq") == 0)
        wl = wl + mqSuff;
      std::ofstream nodes(resultFile + mqSuff, std::ios::app);
@@ -33,12 +33,15 @@
 #include "Galois/Graph/TypeTraits.h"
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
+#include "Lonestar/SchedulerOptions.h"
+#include "Lonestar/DecreaseKeyIndexer.h"
 
 #include <iostream>
 #include <deque>
 #include <set>
 #include <fstream>
 #include <atomic>
+#include <type_traits>
 
 #include "SSSP.h"
 #include "GraphLabAlgo.h"
@@ -75,7 +78,6 @@ static cll::opt<bool> symmetricGraph("symmetricGraph", cll::desc("Input graph is
 static cll::opt<unsigned int> startNode("startNode", cll::desc("Node to start search from"), cll::init(0));
 static cll::opt<unsigned int> reportNode("reportNode", cll::desc("Node to report distance to"), cll::init(1));
 static cll::opt<int> stepShift("delta", cll::desc("Shift value for the deltastep"), cll::init(10));
-static cll::opt<std::string> mqSuff("suff", cll::desc("Suffix for amq or smq"), cll::init(""));
 cll::opt<unsigned int> memoryLimit("memoryLimit",
                                    cll::desc("Memory limit for out-of-core algorithms (in MB)"), cll::init(~0U));
 static cll::opt<Algo> algo("algo", cll::desc("Choose an algorithm:"),
@@ -303,11 +305,11 @@ struct SerialAlgo {
   }
 };
 
-template<bool UseCas>
+template<bool UseCas, bool DecreaseKey = false>
 struct AsyncAlgo {
-  typedef SNode Node;
+  typedef typename std::conditional<DecreaseKey, DecreaseKeySNode, SNode>::type Node;
 
-  typedef Galois::Graph::LC_InlineEdge_Graph<Node, uint32_t>
+  typedef typename Galois::Graph::LC_InlineEdge_Graph<Node, uint32_t>
   ::template with_out_of_line_lockable<true>::type
   ::template with_compressed_node_ptr<true>::type
 #ifdef GEM5
@@ -439,8 +441,13 @@ struct AsyncAlgo {
   };
 
   void operator()(Graph& graph, GNode source) {
+    if constexpr (DecreaseKey)
+      runDecreaseKey(graph, source);
+    else
+      runWorklist(graph, source);
+  }
 
-
+  void runWorklist(Graph& graph, GNode source) {
     using namespace Galois::WorkList;
     typedef UpdateRequestIndexer<UpdateRequest> Indexer;
     typedef dChunkedFIFO<CHUNK_SIZE> Chunk;
@@ -511,12 +518,19 @@ struct AsyncAlgo {
     if (!mqSuff.empty()) {
       mqSuff = "_" + mqSuff;
     }
+
+#define RUN_WL_WITH(WL, OP) do { \
+      if (relaxationStats) \
+        Galois::for_each_local(initial, OP(this, graph), Galois::wl<RelaxationQuality<WL, Comparer>>()); \
+      else \
+        Galois::for_each_local(initial, OP(this, graph), Galois::wl<WL>()); \
+    } while (0)
+#define RUN_WL(WL) RUN_WL_WITH(WL, Process)
+
     if (wl == "obim")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM>());
+      RUN_WL(OBIM);
     else if (wl == "pmod")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<ADAPOBIM>());
-
-#define RUN_WL(WL) Galois::for_each_local(initial, Process(this, graph), Galois::wl<WL>())
+      RUN_WL(ADAPOBIM);
 
 #define priority_t Dist
 #define element_t UpdateRequest
@@ -554,35 +568,35 @@ struct AsyncAlgo {
 //    else if (wl == "obim-glob-nochunk")
 //      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_GLOB_NOCHUNK>());
     if (wl == "skiplist")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<GPQ>());
+      RUN_WL_WITH(GPQ, ProcessWithBreaks);
     else if (wl == "spraylist")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<SL>());
+      RUN_WL_WITH(SL, ProcessWithBreaks);
     else if (wl == "mq1")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<MQ1>());
+      RUN_WL_WITH(MQ1, ProcessWithBreaks);
     else if (wl == "mq2")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<MQ2>());
+      RUN_WL_WITH(MQ2, ProcessWithBreaks);
     else if (wl == "mq3")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<MQ3>());
+      RUN_WL_WITH(MQ3, ProcessWithBreaks);
     else if (wl == "mq4")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<MQ4>());
+      RUN_WL_WITH(MQ4, ProcessWithBreaks);
     else if (wl == "mq5")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<MQ5>());
+      RUN_WL_WITH(MQ5, ProcessWithBreaks);
     else if (wl == "hmq1")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HMQ1>());
+      RUN_WL_WITH(HMQ1, ProcessWithBreaks);
     else if (wl == "hmq2")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HMQ2>());
+      RUN_WL_WITH(HMQ2, ProcessWithBreaks);
     else if (wl == "hmq3")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HMQ3>());
+      RUN_WL_WITH(HMQ3, ProcessWithBreaks);
     else if (wl == "hmq4")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HMQ4>());
+      RUN_WL_WITH(HMQ4, ProcessWithBreaks);
     else if (wl == "hmq5")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HMQ5>());
+      RUN_WL_WITH(HMQ5, ProcessWithBreaks);
     else if (wl == "hmq6")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HMQ6>());
+      RUN_WL_WITH(HMQ6, ProcessWithBreaks);
     else if (wl == "hmq7")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HMQ7>());
+      RUN_WL_WITH(HMQ7, ProcessWithBreaks);
     else if (wl == "hmq8")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HMQ8>());
+      RUN_WL_WITH(HMQ8, ProcessWithBreaks);
 //    else if (wl == "thrskiplist")
 //      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<PTSL>());
 //    else if (wl == "pkgskiplist")
@@ -590,9 +604,9 @@ struct AsyncAlgo {
 //    else if (wl == "lpq")
 //      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<LPQ>());
     else if (wl == "swarm")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<SWARMPQ>());
+      RUN_WL_WITH(SWARMPQ, ProcessWithBreaks);
     else if (wl == "heapswarm")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HSWARMPQ>());
+      RUN_WL_WITH(HSWARMPQ, ProcessWithBreaks);
 //    else if (wl == "ppq")
 //      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<PPQ>());
 //    else if (wl == "klsm256")
@@ -605,11 +619,40 @@ struct AsyncAlgo {
 //      std::cerr << "No work list!" << "\n";
     typedef MyPQ<UpdateRequest, Comparer, true> USUAL_PQ;
     if (worklistname == "pq")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<USUAL_PQ>());
+      RUN_WL(USUAL_PQ);
 
     typedef StealingMultiQueue<element_t, Comparer, 8, 8, true> smq_default;
     if (wl == "smq_default") RUN_WL(smq_default);
+    typedef RuntimeStealingMultiQueue<element_t, Comparer, true> smq;
+    if (wl == "smq") RUN_WL(smq);
+    typedef PackedStealingMultiQueue<element_t, Comparer, Dist, 8, true> smqpacked;
+    if (wl == "smqpacked") RUN_WL(smqpacked);
+    typedef AdaptiveStealingMultiQueue<element_t, Comparer, true> asmq;
+    if (wl == "asmq") RUN_WL(asmq);
+    typedef StealingMultiQueueNuma<element_t, Comparer, 0, 0, 0, true> smqnuma;
+    if (wl == "smqnuma") RUN_WL(smqnuma);
+    typedef RuntimePolicyMultiQueue<element_t, Comparer> policymq;
+    if (wl == "policymq") RUN_WL(policymq);
+    typedef RuntimePolicyMultiQueueNuma<element_t, Comparer> policymqnuma;
+    if (wl == "policymqnuma") RUN_WL(policymqnuma);
+    typedef KLSM<element_t, UpdateRequestIndexer<UpdateRequest>> klsm;
+    if (wl == "klsm") RUN_WL(klsm);
+
+  }
+
+  //! Runs smqdk, only its nodes keep the positions in the heaps.
+  void runDecreaseKey(Graph& graph, GNode source) {
+    using namespace Galois::WorkList;
+    typedef UpdateRequestComparer<UpdateRequest> Comparer;
+    typedef DecreaseKeyStealingMultiQueue<UpdateRequest, Comparer, DecreaseKeyIndexer<UpdateRequest>, true> smqdk;
 
+    Bag initial;
+    graph.getData(source).dist = 0;
+    Galois::do_all(
+    graph.out_edges(source, Galois::MethodFlag::NONE).begin(),
+    graph.out_edges(source, Galois::MethodFlag::NONE).end(),
+    InitialProcess(this, graph, initial, graph.getData(source)));
+    RUN_WL(smqdk);
   }
 };
 
@@ -728,6 +771,8 @@ struct AsyncAlgoPP {
 namespace Galois {
 template<>
 struct does_not_need_aborts<AsyncAlgo<true>::Process> : public boost::true_type {};
+template<>
+struct does_not_need_aborts<AsyncAlgo<true, true>::Process> : public boost::true_type {};
 }
 
 static_assert(Galois::does_not_need_aborts<AsyncAlgo<true>::Process>::value, "Oops");
@@ -805,6 +850,7 @@ uint64_t getStatVal(Galois::Statistic* value) {
 int main(int argc, char **argv) {
   Galois::StatManager statManager;
   LonestarStart(argc, argv, name, desc, url);
+  applySchedulerOptions();
 
   if (trackWork) {
     BadWork = new Galois::Statistic("BadWork");
@@ -821,8 +867,14 @@ int main(int argc, char **argv) {
 
   switch (algo) {
     case Algo::serial: run<SerialAlgo>(); break;
-    case Algo::async: run<AsyncAlgo<false> >(); break;
-    case Algo::asyncWithCas: run<AsyncAlgo<true> >(); break;
+    case Algo::async:
+      if (worklistname == "smqdk") run<AsyncAlgo<false, true> >();
+      else run<AsyncAlgo<false> >();
+      break;
+    case Algo::asyncWithCas:
+      if (worklistname == "smqdk") run<AsyncAlgo<true, true> >();
+      else run<AsyncAlgo<true> >();
+      break;
     case Algo::asyncPP: run<AsyncAlgoPP>(); break;
 #if defined(__IBMCPP__) && __IBMCPP__ <= 1210
 #else
@@ -837,6 +889,25 @@ int main(int argc, char **argv) {
 
   if (trackWork) {
     std::string wl = worklistname;
+    if (wl == "smq")
+      wl = "smqhm_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch);
+    if (wl == "smqpacked")
+      wl = "smqpackedhm_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch);
+    if (wl == "smqdk")
+      wl = "smqdkhm_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch);
+    if (wl == "smqnuma")
+      wl = "smqhmnuma_" + std::to_string(stealProb) + "_" + std::to_string(stealBatch)
+         + "_" + std::to_string(numaWeight);
+    if (wl == "policymq" || wl == "policymqnuma") {
+      // Named as the heatmaps of the policies: r -- random or two-choice,
+      // p -- temporal, l -- batching.
+      const char letters[] = "rpl";
+      const bool numa = wl == "policymqnuma";
+      wl = std::string("mq") + letters[mqInsert] + letters[mqDelete] + (numa ? "numa_" : "_")
+         + std::to_string(mqC) + "_" + std::to_string(mqInsertParam) + "_" + std::to_string(mqDeleteParam);
+      if (numa)
+        wl += "_" + std::to_string(numaWeight);
+    }
     if (wl.find("smq") == 0)
       wl = wl + mqSuff;
     std::ofstream nodes(amqResultFile + mqSuff, std::ios::app);
@@ -29,6 +29,7 @@
 
 #include "llvm/Support/CommandLine.h"
 
+#include <atomic>
 #include <limits>
 #include <string>
 #include <sstream>
@@ -84,6 +85,12 @@ struct SNode {
   Dist dist;
 };
 
+//! Node of the decrease-key worklist, which keeps the position of the
+//! node in its heaps, see DecreaseKeyIndexer.
+struct DecreaseKeySNode: public SNode {
+  std::atomic<uint64_t> index = {0};
+};
+
 template<typename Graph>
 void readInOutGraph(Graph& graph);
 
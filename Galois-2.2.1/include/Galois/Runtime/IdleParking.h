@@ -0,0 +1,157 @@
+/** Parking of idle threads -*- C++ -*-
+ * @file
+ * @section License
+ *
+ * Galois, a framework to exploit amorphous data-parallelism in irregular
+ * programs.
+ *
+ * Copyright (C) 2013, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ *
+ * @section Description
+ *
+ * Lets the threads of a parallel loop sleep, while they find no work,
+ * independently of the worklist.
+ */
+#ifndef GALOIS_RUNTIME_IDLEPARKING_H
+#define GALOIS_RUNTIME_IDLEPARKING_H
+
+#include "Galois/Runtime/ActiveThreads.h"
+#include "Galois/Runtime/PerThreadStorage.h"
+#include "Galois/Runtime/ll/CompilerSpecific.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace Galois {
+namespace Runtime {
+
+/**
+ * Runtime parameters of IdleParking, they are read when a loop starts.
+ */
+struct IdleParkingParams {
+  //! Number of rounds without work, after which a thread parks.
+  //! 0 disables parking.
+  static unsigned& parkAfter() {
+    static unsigned value = 0;
+    return value;
+  }
+
+  //! Maximal time a thread stays parked, so that a missed wake up
+  //! only delays it.
+  static unsigned& parkTimeoutUs() {
+    static unsigned value = 1000;
+    return value;
+  }
+
+  //! A parked thread is woken per this many pushed elements.
+  static unsigned& pushesPerWake() {
+    static unsigned value = 16;
+    return value;
+  }
+};
+
+/**
+ * Idle threads of a loop back off exponentially and then park on their
+ * own condition variable. Pushes wake a number of parked threads
+ * proportional to the number of pushed elements, the termination
+ * detection wakes the thread it passes the token to.
+ */
+class IdleParking {
+  struct Slot {
+    std::mutex lock;
+    std::condition_variable cond;
+    std::atomic<bool> parked{false};
+    //! Set by a wake up, which came before the thread parked.
+    bool wake = false;
+  };
+
+  PerThreadStorage<Slot> slots;
+  std::atomic<unsigned> parkedNum{0};
+  //! Slot to start looking for the threads to wake up from.
+  std::atomic<unsigned> nextWake{0};
+  const unsigned parkAfter;
+  const std::chrono::microseconds timeout;
+  const unsigned pushesPerWake;
+
+public:
+  IdleParking() :
+      parkAfter(IdleParkingParams::parkAfter()),
+      timeout(IdleParkingParams::parkTimeoutUs()),
+      pushesPerWake(std::max(1u, IdleParkingParams::pushesPerWake())) {}
+
+  bool enabled() const {
+    return parkAfter != 0;
+  }
+
+  //! Called by a thread after every round, `idleRounds` is the number
+  //! of the last rounds without work.
+  void idle(unsigned tid, unsigned idleRounds) {
+    if (idleRounds < parkAfter) {
+      const unsigned spins = 1u << std::min(idleRounds, 10u);
+      for (unsigned i = 0; i < spins; i++) {
+        LL::asmPause();
+      }
+      return;
+    }
+    Slot& slot = *slots.getRemote(tid);
+    std::unique_lock<std::mutex> lk(slot.lock);
+    if (!slot.wake) {
+      slot.parked.store(true, std::memory_order_relaxed);
+      parkedNum.fetch_add(1, std::memory_order_relaxed);
+      slot.cond.wait_for(lk, timeout, [&slot] { return slot.wake; });
+      parkedNum.fetch_sub(1, std::memory_order_relaxed);
+      slot.parked.store(false, std::memory_order_relaxed);
+    }
+    slot.wake = false;
+  }
+
+  //! Wakes the thread up, if it is going to park, it returns at once.
+  void wake(unsigned tid) {
+    Slot& slot = *slots.getRemote(tid);
+    std::lock_guard<std::mutex> lk(slot.lock);
+    slot.wake = true;
+    if (slot.parked.load(std::memory_order_relaxed)) {
+      slot.cond.notify_one();
+    }
+  }
+
+  //! Wakes parked threads for `pushed` new elements.
+  void pushed(unsigned pushed) {
+    if (parkedNum.load(std::memory_order_relaxed) == 0) return;
+    unsigned toWake = (pushed + pushesPerWake - 1) / pushesPerWake;
+    const unsigned start = nextWake.fetch_add(1, std::memory_order_relaxed);
+    for (unsigned i = 0; i < activeThreads && toWake > 0; i++) {
+      const unsigned tid = (start + i) % activeThreads;
+      if (slots.getRemote(tid)->parked.load(std::memory_order_relaxed)) {
+        wake(tid);
+        toWake--;
+      }
+    }
+  }
+
+  //! Wakes all the threads, when the loop terminates.
+  void wakeAll() {
+    for (unsigned tid = 0; tid < activeThreads; tid++) {
+      wake(tid);
+    }
+  }
+};
+
+} // end namespace Runtime
+} // end namespace Galois
+
+#endif
@@ -33,6 +33,7 @@
 #include "Galois/Runtime/Barrier.h"
 #include "Galois/Runtime/Context.h"
 #include "Galois/Runtime/ForEachTraits.h"
+#include "Galois/Runtime/IdleParking.h"
 #include "Galois/Runtime/Range.h"
 #include "Galois/Runtime/Support.h"
 #include "Galois/Runtime/Termination.h"
@@ -291,6 +292,7 @@ protected:
 
   AbortHandler<value_type> aborted;
   TerminationDetection& term;
+  IdleParking parking;
 
   WLTy wl;
   FunctionTy& origFunction;
@@ -304,6 +306,7 @@ protected:
       if (ii != ee) {
 	tld.stat.add_galois_time(tld.facing.t.stopwatch());
 	unsigned int npush = wl.push(ii, ee);
+	parking.pushed(npush);
 	tld.stat.add_push_time(tld.facing.t.stopwatch(), npush);
 	tld.facing.resetPushBuffer();
       }
@@ -448,6 +451,7 @@ protected:
   void fastPushBack(ThreadLocalData& tld, typename UserContextAccess<value_type>::PushBufferTy& x) {
     tld.facing.u += tld.facing.t.stopwatch();
     unsigned int npush = wl.push(x.begin(), x.end());
+    parking.pushed(npush);
     tld.stat.add_push_time(tld.facing.t.stopwatch(), npush);
     x.clear();
   }
@@ -466,6 +470,7 @@ protected:
       tld.facing.setFastPushBack(
           std::bind(&ForEachWork::fastPushBack, std::ref(*this), std::ref(tld), std::placeholders::_1));
     bool didWork;
+    unsigned idleRounds = 0;
     do {
       didWork = false;
       tt_comp.stopwatch();
@@ -484,8 +489,16 @@ protected:
       tld.stat.add_comp_time(tt_comp.stopwatch());
       // Update node color and prop token
       term.localTermination(didWork);
+      if (parking.enabled()) {
+        idleRounds = didWork ? 0 : idleRounds + 1;
+        if (idleRounds && !term.globalTermination())
+          parking.idle(LL::getTID(), idleRounds - 1);
+      }
     } while (!term.globalTermination() && (!ForEachTraits<FunctionTy>::NeedsBreak || !broke));
 
+    if (parking.enabled())
+      parking.wakeAll();
+
     tld.stat.add_galois_time(tld.facing.t.stopwatch());
     tld.facing.t.stop();
     if (couldAbort)
@@ -493,10 +506,20 @@ protected:
   }
 
 public:
-  ForEachWork(FunctionTy& f, const char* l): term(getSystemTermination()), origFunction(f), loopname(l), broke(false) { }
+  ForEachWork(FunctionTy& f, const char* l): term(getSystemTermination()), origFunction(f), loopname(l), broke(false) {
+    if (parking.enabled())
+      term.setParking(&parking);
+  }
 
   template<typename W>
-  ForEachWork(W& w, FunctionTy& f, const char* l): term(getSystemTermination()), wl(w), origFunction(f), loopname(l), broke(false) { }
+  ForEachWork(W& w, FunctionTy& f, const char* l): term(getSystemTermination()), wl(w), origFunction(f), loopname(l), broke(false) {
+    if (parking.enabled())
+      term.setParking(&parking);
+  }
+
+  ~ForEachWork() {
+    term.setParking(nullptr);
+  }
 
   template<typename RangeTy>
   void AddInitialWork(const RangeTy& range) {
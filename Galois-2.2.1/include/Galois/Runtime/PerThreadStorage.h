@@ -42,7 +42,7 @@ namespace Runtime {
 
 class PerBackend {
   static const unsigned MAX_SIZE = 50;
-  static const unsigned MIN_SIZE = 3; // 8 bytes
+  static const unsigned MIN_SIZE = 4; // 16 bytes, keeps 128-bit members aligned
 
   unsigned int nextLoc;
   std::vector<char*> heads;
@@ -36,10 +36,22 @@
 namespace Galois {
 namespace Runtime {
 
+class IdleParking;
+
 class TerminationDetection {
 protected:
   LL::CacheLineStorage<volatile bool> globalTerm;
+  //! Threads of the running loop, which may be parked
+  IdleParking* parking = nullptr;
 public:
+  /**
+   * Sets the parking of the threads, which are woken up when the token
+   * is passed to them. nullptr, if the threads do not park.
+   */
+  void setParking(IdleParking* p) {
+    parking = p;
+  }
+
   /**
    * Initializes the per-thread state.  All threads must call this
    * before any call localTermination.
@@ -45,6 +45,9 @@ unsigned getMaxCores();
 unsigned getMaxPackages();
 //! Map thread to package
 unsigned getPackageForThread(int galois_thread_id);
+
+//! Map thread to core, threads on the same core are SMT siblings
+unsigned getCoreForThread(int galois_thread_id);
 //! Find the maximum package number for all threads up to and including id
 unsigned getMaxPackageForThread(int galois_thread_id);
 //! is this the first thread in a package
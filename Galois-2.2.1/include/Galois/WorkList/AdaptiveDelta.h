@@ -0,0 +1,259 @@
+/** Runtime delta controller of the bucketed priority worklists -*- C++ -*-
+ * @file
+ * @section License
+ *
+ * Galois, a framework to exploit amorphous data-parallelism in irregular
+ * programs.
+ *
+ * Copyright (C) 2013, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ *
+ * @section Description
+ *
+ * Merges and splits the priority bins of OBIM and PMOD at runtime by
+ * changing the number of low priority bits, which are ignored.
+ */
+#ifndef GALOIS_WORKLIST_ADAPTIVEDELTA_H
+#define GALOIS_WORKLIST_ADAPTIVEDELTA_H
+
+#include "Galois/Runtime/PerThreadStorage.h"
+#include "Galois/Runtime/Support.h"
+#include "Galois/Runtime/ll/TID.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+namespace Galois {
+namespace WorkList {
+
+/**
+ * Runtime parameters of AdaptiveDelta, they are read when a worklist is
+ * constructed.
+ */
+struct AdaptiveDeltaParams {
+  //! Pushes per bin, the controller aims at. 0 -- the chunk size of the
+  //! worklist.
+  static unsigned& pushesPerBin() {
+    static unsigned value = 0;
+    return value;
+  }
+
+  //! Splits the bins again, when a thread keeps popping from a few
+  //! crowded ones.
+  static bool& unmerge() {
+    static bool value = false;
+    return value;
+  }
+};
+
+/**
+ * Delta controller of PMOD, shared by the bucketed worklists. Delta is
+ * the number of the low priority bits, which a worklist ignores.
+ *
+ * Every thread counts its pushes and the range of their priorities in the
+ * current period. Thread 0 decides at its slow pops: when the pops often
+ * find their bin empty and the last period pushed less than half of the
+ * target per bin, the bins are merged by raising delta, and the period is
+ * doubled. Optionally, when thread 0 keeps popping from fewer than 16
+ * crowded bins, delta is lowered again.
+ *
+ * The decisions are kept in a ring buffer and reported, together with the
+ * final delta, by report().
+ *
+ * @tparam Index integral priority
+ */
+template<typename Index>
+class AdaptiveDelta {
+  struct PerThread {
+    //! Period, which the counters below belong to.
+    std::atomic<unsigned> period;
+    std::atomic<uint64_t> pushes;
+    std::atomic<Index> minPrio;
+    std::atomic<Index> maxPrio;
+    //! Used by the owner only.
+    uint64_t pops;
+    uint64_t slowPops;
+    uint64_t popsFromSameBin;
+
+    PerThread() : period(0), pushes(0),
+      minPrio(std::numeric_limits<Index>::max()),
+      maxPrio(std::numeric_limits<Index>::min()),
+      pops(0), slowPops(0), popsFromSameBin(0) { }
+  };
+
+  struct Decision {
+    uint64_t pops;
+    unsigned delta;
+  };
+
+  static const unsigned MAX_DELTA = sizeof(Index) * 8 - 2;
+  static const size_t LOG_SIZE = 64;
+
+  Runtime::PerThreadStorage<PerThread> threads;
+  std::atomic<unsigned> curDelta;
+  std::atomic<unsigned> period;
+  const unsigned target;
+  const bool unmerge;
+  //! Pops of thread 0, after which it decides again.
+  uint64_t periodLength;
+  //! Decisions, written by thread 0 only.
+  std::array<Decision, LOG_SIZE> decisions;
+  uint64_t numDecisions;
+  uint64_t totalPops;
+
+  static void increment(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  void setDelta(unsigned delta) {
+    curDelta.store(delta, std::memory_order_relaxed);
+    decisions[numDecisions % LOG_SIZE] = {totalPops, delta};
+    numDecisions++;
+  }
+
+  //! Starts a new period, threads reset their counters at their next push.
+  void newPeriod(PerThread& t) {
+    period.fetch_add(1, std::memory_order_relaxed);
+    t.pops = 0;
+    t.slowPops = 0;
+  }
+
+  void merge(PerThread& t) {
+    const unsigned cur = period.load(std::memory_order_relaxed);
+    const unsigned delta = curDelta.load(std::memory_order_relaxed);
+    uint64_t pushes = 0;
+    Index minOfMin = std::numeric_limits<Index>::max();
+    Index maxOfMax = std::numeric_limits<Index>::min();
+    for (unsigned i = 0; i < Runtime::activeThreads; ++i) {
+      PerThread& o = *threads.getRemote(i);
+      if (o.period.load(std::memory_order_relaxed) != cur)
+        continue;
+      pushes += o.pushes.load(std::memory_order_relaxed);
+      minOfMin = std::min(minOfMin, o.minPrio.load(std::memory_order_relaxed));
+      maxOfMax = std::max(maxOfMax, o.maxPrio.load(std::memory_order_relaxed));
+    }
+    newPeriod(t);
+    if (pushes == 0 || maxOfMax < minOfMin)
+      return;
+    const double bins = (double) ((maxOfMax >> delta) - (minOfMin >> delta));
+    if (bins <= 0 || pushes / bins >= target / 2.0)
+      return;
+    const unsigned inc = (unsigned) std::floor(std::log2(target * bins / pushes));
+    if (inc == 0 || delta == MAX_DELTA)
+      return;
+    setDelta(std::min(MAX_DELTA, delta + inc));
+    periodLength *= 2;
+  }
+
+  void split(PerThread& t) {
+    const unsigned delta = curDelta.load(std::memory_order_relaxed);
+    const Index minPrio = t.minPrio.load(std::memory_order_relaxed);
+    const Index maxPrio = t.maxPrio.load(std::memory_order_relaxed);
+    if (maxPrio < minPrio)
+      return;
+    const double bins = std::max(1.0, (double) ((maxPrio >> delta) - (minPrio >> delta)));
+    if (bins >= 16 || t.pushes.load(std::memory_order_relaxed) / bins <= 4.0 * target)
+      return;
+    const unsigned dec = (unsigned) std::floor(std::log2(16 / bins));
+    setDelta(delta > dec ? delta - dec : 0);
+    newPeriod(t);
+  }
+
+public:
+  /**
+   * @param defaultTarget Pushes per bin to aim at, unless
+   * AdaptiveDeltaParams::pushesPerBin() is set.
+   */
+  explicit AdaptiveDelta(unsigned defaultTarget) :
+    curDelta(0), period(0),
+    target(std::max(1u, AdaptiveDeltaParams::pushesPerBin() ? AdaptiveDeltaParams::pushesPerBin() : defaultTarget)),
+    unmerge(AdaptiveDeltaParams::unmerge()),
+    periodLength(target), numDecisions(0), totalPops(0) { }
+
+  unsigned delta() const {
+    return curDelta.load(std::memory_order_relaxed);
+  }
+
+  //! Lowest priority of the bin of `k`.
+  Index binOf(Index k) const {
+    return k & ~((Index(1) << delta()) - 1);
+  }
+
+  void pushed(Index k) {
+    PerThread& t = *threads.getLocal();
+    const unsigned cur = period.load(std::memory_order_relaxed);
+    if (t.period.load(std::memory_order_relaxed) != cur) {
+      t.pushes.store(0, std::memory_order_relaxed);
+      t.minPrio.store(std::numeric_limits<Index>::max(), std::memory_order_relaxed);
+      t.maxPrio.store(std::numeric_limits<Index>::min(), std::memory_order_relaxed);
+      t.period.store(cur, std::memory_order_relaxed);
+    }
+    increment(t.pushes);
+    if (k < t.minPrio.load(std::memory_order_relaxed))
+      t.minPrio.store(k, std::memory_order_relaxed);
+    if (k > t.maxPrio.load(std::memory_order_relaxed))
+      t.maxPrio.store(k, std::memory_order_relaxed);
+  }
+
+  //! Called by every pop, `sameBin` tells if it was served by the bin of
+  //! the previous pop.
+  void popped(bool sameBin) {
+    PerThread& t = *threads.getLocal();
+    t.pops++;
+    if (sameBin)
+      t.popsFromSameBin++;
+  }
+
+  //! Called, when a pop looks for another bin. Thread 0 adjusts delta.
+  void slowPop() {
+    PerThread& t = *threads.getLocal();
+    t.slowPops++;
+    if (Runtime::LL::getTID() == 0 && t.pops > periodLength) {
+      totalPops += t.pops;
+      if (t.slowPops * (double) target > t.pops)
+        merge(t);
+      else if (unmerge && delta() > 0 && t.popsFromSameBin > 4 * (uint64_t) target)
+        split(t);
+    }
+    t.popsFromSameBin = 0;
+  }
+
+  /**
+   * Reports the final delta and the number of the changes as
+   * `<name>FinalDelta` and `<name>DeltaChanges`. The last changes are
+   * reported as `<name>Delta_<nn>` with the new delta and
+   * `<name>DeltaPops_<nn>` with the pops of thread 0 before the change.
+   */
+  void report(std::string const& name) const {
+    Galois::Runtime::reportStat(nullptr, (name + "FinalDelta").c_str(), delta());
+    Galois::Runtime::reportStat(nullptr, (name + "DeltaChanges").c_str(), numDecisions);
+    const uint64_t first = numDecisions > LOG_SIZE ? numDecisions - LOG_SIZE : 0;
+    for (uint64_t i = first; i < numDecisions; ++i) {
+      const Decision& d = decisions[i % LOG_SIZE];
+      std::string n = std::to_string(i - first);
+      n = std::string(n.size() < 2 ? 2 - n.size() : 0, '0') + n;
+      Galois::Runtime::reportStat(nullptr, (name + "Delta_" + n).c_str(), d.delta);
+      Galois::Runtime::reportStat(nullptr, (name + "DeltaPops_" + n).c_str(), d.pops);
+    }
+  }
+};
+
+} // end namespace WorkList
+} // end namespace Galois
+
+#endif
@@ -23,19 +23,12 @@
 #ifndef GALOIS_WORKLIST_ADAPTIVEOBIM_H
 #define GALOIS_WORKLIST_ADAPTIVEOBIM_H
 
-// #define UNMERGE_ENABLED
-
-//#define OBIM_ADAP_DBG
-#ifdef OBIM_ADAP_DBG
-#define ERR_MSG std::cout
-#else
-#define ERR_MSG if(0) std::cout
-#endif
-
 #include "Galois/config.h"
 #include "Galois/FlatMap.h"
 #include "Galois/Timer.h"
 #include "Galois/Runtime/PerThreadStorage.h"
+#include "Galois/WorkList/AdaptiveDelta.h"
+#include "Galois/WorkList/Chunked.h"
 #include "Galois/WorkList/Fifo.h"
 #include "Galois/WorkList/WorkListHelpers.h"
 
@@ -44,7 +37,6 @@
 #include GALOIS_CXX11_STD_HEADER(type_traits)
 #include <limits>
 #include <atomic>
-#include <iostream>
 #include <cmath>
 #include <type_traits>
 
@@ -75,6 +67,13 @@ namespace WorkList {
  * @tparam BlockPeriod Check for higher priority work every 2^BlockPeriod
  *                     iterations
  * @tparam BSP Use back-scan prevention
+ * @tparam chunk_size Pushes per bin, which AdaptiveDelta aims at, unless
+ *                    AdaptiveDeltaParams::pushesPerBin() is set. It is
+ *                    capped by ChunkedParams::chunkSize() like the chunks
+ *                    of the bins
+ *
+ * The bins are merged and split at runtime by AdaptiveDelta, its decisions
+ * are reported at the end of the loop.
  */
 template<class Indexer = DummyIndexer<int>, typename Container = FIFO<>,
   int BlockPeriod=0,
@@ -106,8 +105,6 @@ struct AdaptiveOrderedByIntegerMetric : private boost::noncopyable {
   typedef T value_type;
 
 private:
-  unsigned int delta;
-  unsigned int counter;
   unsigned int maxIndex;
   unsigned int lastSizeMasterLog;
 
@@ -199,30 +196,10 @@ private:
     unsigned int lastMasterVersion;
     unsigned int numPops;
 
-    //per thread lock
-
-    unsigned int sinceLastFix;
-    unsigned int slowPopsLastPeriod;
-    unsigned int pushesLastPeriod;
-    unsigned int priosLastPeriod;
-
-    unsigned long pmodAllDeq;
-
-    unsigned int popsFromSameQ;
-    unsigned int ctr;
-
-    Index maxPrioDiffLastPeriod;
-    Index minPrio;
-    Index maxPrio;
-    Runtime::LL::PaddedLock<Concurrent> lock;
-
-
     perItem() :
       //curIndex(std::numeric_limits<Index>::min()),
       //scanStart(std::numeric_limits<Index>::min()),
-      current(0), lastMasterVersion(0), numPops(0), sinceLastFix(0),
-      pushesLastPeriod(0), priosLastPeriod(0), maxPrioDiffLastPeriod(0), popsFromSameQ(0), ctr(0),
-      minPrio(std::numeric_limits<Index>::max()), maxPrio(std::numeric_limits<Index>::min()), pmodAllDeq(0)
+      current(0), lastMasterVersion(0), numPops(0)
       { }
   };
 
@@ -238,6 +215,7 @@ private:
   Runtime::MM::FixedSizeAllocator heap;
   std::atomic<unsigned int> masterVersion;
   Indexer indexer;
+  AdaptiveDelta<Index> adaptive;
 
   bool updateLocal(perItem& p) {
     if (p.lastMasterVersion != masterVersion.load(std::memory_order_relaxed)) {
@@ -263,114 +241,9 @@ private:
   Galois::optional<T> slowPop(perItem& p) {
     //Failed, find minimum bin
     //counter=100;
-    p.slowPopsLastPeriod++;
+    adaptive.slowPop();
     unsigned myID = Runtime::LL::getTID();
 
-    //first give it some time
-    //then check the fdeq frequency
-    if(myID == 0 && p.sinceLastFix>counter
-      && ((double)(p.slowPopsLastPeriod)/(double)(p.sinceLastFix)) > 1.0/(double)(chunk_size)){
-      //std::cout<<"Master Log Size: "<<masterLog.size()<<std::endl;
-      for (unsigned i = 1; i < Runtime::activeThreads; ++i){
-        while(current.getRemote(i)->lock.try_lock());
-      }
-      unsigned long priosCreatedThisPeriod=0;
-      unsigned long numPushesThisStep=0;
-      unsigned long allPmodDeqCounts = 0;
-      Index minOfMin = std::numeric_limits<Index>::max();
-      Index maxOfMax = std::numeric_limits<Index>::min();
-      ERR_MSG<<"Locked everyone else"<<std::endl;
-      for(unsigned i=0; i<Runtime::activeThreads; ++i){
-      //  ERR_MSG<<"Thread i: "<<i<<" numPopsSinceLastFix "<<current.getRemote(i)->sinceLastFix<<std::endl;
-      //  ERR_MSG<<"\tThread i: "<<i<<" pushesLastPeriod "<<current.getRemote(i)->pushesLastPeriod<<std::endl;
-      //  ERR_MSG<<"\tThread i: "<<i<<" priosLastPeriod "<<current.getRemote(i)->priosLastPeriod<<std::endl;
-        minOfMin = std::min(minOfMin,current.getRemote(i)->minPrio);
-        maxOfMax = std::max(maxOfMax, current.getRemote(i)->maxPrio);
-        //ERR_MSG<<"\tThread i: "<<i<<" maxPrioDiffLastPeriod "<<current.getRemote(i)->maxPrioDiffLastPeriod<<std::endl;
-        priosCreatedThisPeriod+=current.getRemote(i)->priosLastPeriod;
-        numPushesThisStep+=current.getRemote(i)->pushesLastPeriod;
-        allPmodDeqCounts+=current.getRemote(i)->pmodAllDeq;
-        current.getRemote(i)->sinceLastFix=0;
-        current.getRemote(i)->slowPopsLastPeriod=0;
-        current.getRemote(i)->pushesLastPeriod=0;
-        current.getRemote(i)->priosLastPeriod=0;
-        current.getRemote(i)->maxPrioDiffLastPeriod=0;
-
-        current.getRemote(i)->minPrio = std::numeric_limits<Index>::max();
-        current.getRemote(i)->maxPrio = std::numeric_limits<Index>::min();
-      }
-
-      if(((double)numPushesThisStep/((double)((maxOfMax>>delta)-(minOfMin>>delta))))< chunk_size/2){
-        double xx = ((double)(chunk_size)/((double)numPushesThisStep/((double)((maxOfMax>>delta)-(minOfMin>>delta)))));
-        ERR_MSG<<"Chunk size over "<<xx<<std::endl;
-        ERR_MSG<<"Delta increase: "<<std::log2(xx)<<std::endl;
-        delta+=std::floor(std::log2(xx));
-        std::cout<<"Delta "<<delta<<" "<<(allPmodDeqCounts)<<std::endl;
-        counter*=2;
-        //ERR_MSG<<"Increase delta by "<<((maxOfMax>>delta) - (minOfMin>>delta))/16<<std::endl;
-      }
-
-      for (unsigned i = 1; i < Runtime::activeThreads; ++i){
-        current.getRemote(i)->lock.unlock();
-      }
-      //counter*=2;
-      ERR_MSG<<"Priorities created for this step "<<priosCreatedThisPeriod<<std::endl;
-      ERR_MSG<<"Push/Prio ratio "<<((double)(priosCreatedThisPeriod)/(double)(numPushesThisStep))<<std::endl;
-      ERR_MSG<<"Min "<<minOfMin<<" max "<<maxOfMax<<" bins "<<(minOfMin>>delta)<<" "<<(maxOfMax>>delta)<<" pushes "<<numPushesThisStep<<" Ratio "<<((double)numPushesThisStep/((double)((maxOfMax>>delta)-(minOfMin>>delta))))<< std::endl;
-      ERR_MSG<<"Unlocked everyone else"<<std::endl;
-    }
-    #ifdef UNMERGE_ENABLED
-    // serif added here
-    // make sure delta is bigger than 0 so that we can actually unmerge things
-    // give it some time and check the same queue pops
-    else if(delta > 0 && myID == 0 && p.sinceLastFix>counter&& p.popsFromSameQ > 4*chunk_size){
-      // std::cout<<"1Same queue dequeue"<<std::endl;
-      if(((p.maxPrio>>delta)-(p.minPrio>>delta))<16
-         && ((double)p.pushesLastPeriod/((double)((p.maxPrio>>delta)-(p.minPrio>>delta))))> 4*chunk_size){ // this is a check to make sure we are also pushing with the same frequency end of execution
-        // std::cout<<"Same queue dequeue "<<p.ctr<<" "<<masterLog.size()<<std::endl;
-        // std::cout<<((p.maxPrio>>delta)-(p.minPrio>>delta))<<std::endl;
-        double diff = ((p.maxPrio>>delta)-(p.minPrio>>delta))>=1 ? ((p.maxPrio>>delta)-(p.minPrio>>delta)) : 1;
-        double xx = 16 / diff;
-        std::cout<<delta<<" "<<std::floor(std::log2(xx))<<" "<<xx<<std::endl;
-        if(delta>(unsigned int)(std::floor(std::log2(xx))))
-          delta -= (unsigned int)(std::floor(std::log2(xx)));
-        else
-          delta=0;
-        std::cout<<"Delta decreased to"<<delta<<std::endl;
-
-        for (unsigned i = 1; i < Runtime::activeThreads; ++i){
-          while(current.getRemote(i)->lock.try_lock());
-        }
-
-        ERR_MSG<<"Locked everyone else"<<std::endl;
-        for(unsigned i=0; i<Runtime::activeThreads; ++i){
-
-          current.getRemote(i)->sinceLastFix=0;
-          current.getRemote(i)->slowPopsLastPeriod=0;
-          current.getRemote(i)->pushesLastPeriod=0;
-          current.getRemote(i)->priosLastPeriod=0;
-          current.getRemote(i)->maxPrioDiffLastPeriod=0;
-
-          current.getRemote(i)->minPrio = std::numeric_limits<Index>::max();
-          current.getRemote(i)->maxPrio = std::numeric_limits<Index>::min();
-          // current.getRemote(i)->lock.unlock();
-        }
-
-        for (unsigned i = 1; i < Runtime::activeThreads; ++i){
-          current.getRemote(i)->lock.unlock();
-        }
-        p.ctr++;
-      }
-      p.popsFromSameQ=0;
-    }
-    #endif
-    p.popsFromSameQ=0;
-    // if(myID == 0 && p.sinceLastFix>counter
-    //   && ((double)(p.slowPopsLastPeriod)/(double)(p.sinceLastFix)) > 1.0/(double)(chunk_size)){
-
-    // }
-
-    //p.lastNumPops=p.numPops;
     updateLocal(p);
     //unsigned myID = Runtime::LL::getTID();
     bool localLeader = Runtime::LL::isPackageLeaderForSelf(myID);
@@ -395,11 +268,10 @@ private:
         p.current = ii->second;
         p.curIndex = ii->first;
         p.scanStart = ii->first;
-        p.lock.unlock();
+        adaptive.popped(false);
         return retval;
       }
     }
-    p.lock.unlock();
     return Galois::optional<value_type>();
   }
 
@@ -421,7 +293,6 @@ private:
       masterLog.push_back(std::make_pair(i, lC2));
       masterVersion.fetch_add(1);
       (*numberOfPris)+=1;
-      p.priosLastPeriod++;
       //perPriorityCntr[i]=0;
     }
     masterLock.unlock();
@@ -440,19 +311,15 @@ private:
 public:
   static Galois::Statistic* numberOfPris;
   static Galois::Statistic* pmodNumDeq;
-  AdaptiveOrderedByIntegerMetric(const Indexer& x = Indexer()): heap(sizeof(CTy)), masterVersion(0), indexer(x) {
+  AdaptiveOrderedByIntegerMetric(const Indexer& x = Indexer()): heap(sizeof(CTy)), masterVersion(0), indexer(x), adaptive(ChunkedParams::effective(chunk_size)) {
     clock.start();
-    delta=0;
-    counter= chunk_size;
     if(numberOfPris == 0){
       numberOfPris = new Galois::Statistic("numberOfPris");
       //(*numberOfPris )=0;
-      std::cout<<"Number of Pris statistics created\n";
     }
     if(pmodNumDeq == 0){
       pmodNumDeq = new Galois::Statistic("pmodNumDeq");
       //(*numberOfPris )=0;
-      std::cout<<"pmodNumDeq statistics created\n";
     }
   }
 
@@ -468,19 +335,13 @@ public:
       heap.deallocate(lC);
     }
 
-    std::cout<<"Final delta "<<delta<<std::endl;
-    //print incomplete pop
-    // for (unsigned i = 0; i < Runtime::activeThreads; ++i){
-    //   std::cout<<"Thread i:"<<i<<" incomplete pops: "<<current.getRemote(i)->incompleteChunks<<" consec. incomplete pops: "<<current.getRemote(i)->consec1IncompleteChunks<<std::endl;
-    // }
+    adaptive.report("Pmod");
 
     if(numberOfPris!=0){
-      std::cout<<"Number of Pris statistics dealloced\n";
       delete numberOfPris;
       //numberOfPris=NULL;
     }
     if(pmodNumDeq!=0){
-      std::cout<<"pmodNumDeq statistics dealloced\n";
       delete pmodNumDeq;
       //numberOfPris=NULL;
     }
@@ -501,7 +362,6 @@ public:
 
   void push(const value_type& val) {
     perItem& p = *current.getLocal();
-    while (!p.lock.try_lock());
     Index ind;
     if constexpr(std::is_fundamental<value_type>::value) {
       ind = val;
@@ -512,31 +372,12 @@ public:
     //(val()>>delta)+maxIndex;//indexer(val);
     deltaIndex index;
     index.k = ind;
-    index.d = delta;
-    // assert(index.k>p.curIndex.k);
-    // Index kk = (index.k>>delta);
-    // Index ll =(p.curIndex.k>>delta);
-    // assert(kk<=ll);
-    // if(p.maxPrioDiffLastPeriod < kk-ll ){
-    //   p.maxPrioDiffLastPeriod = kk-ll;
-    //   if (kk-ll == 4294967295){
-    //     std::cout<<"in "<<index.k<<" "<<(kk)<<" "<<p.curIndex.k<<" "<<ll<<std::endl;
-    //   }
-    //
-    //   //
-    // }
-    if(index.k > p.maxPrio){
-      p.maxPrio = index.k;
-    }
-    if(index.k< p.minPrio){
-      p.minPrio = index.k;
-    }
-    p.pushesLastPeriod++;
+    index.d = adaptive.delta();
+    adaptive.pushed(ind);
 
     // Fast path
     if (index == p.curIndex && p.current) {
       p.current->push(val);
-      p.lock.unlock();
       return;
     }
 
@@ -547,13 +388,10 @@ public:
     // Opportunistically move to higher priority work
     if (index < p.curIndex) {
       //we moved to a higher prio
-      p.popsFromSameQ=0;
-
       p.curIndex = index;
       p.current = lC;
     }
     lC->push(val);
-    p.lock.unlock();
   }
 
   template<typename Iter>
@@ -574,68 +412,15 @@ public:
     // Find a successful pop
     (*pmodNumDeq)+=1;
     perItem& p = *current.getLocal();
-    while (!p.lock.try_lock());
-
-    p.sinceLastFix++;
-
-    unsigned myID = Runtime::LL::getTID();
-
-    current.getRemote(myID)->pmodAllDeq++;
-    /*
-    if(delta > 0 && myID == 0 && p.sinceLastFix>counter&& p.popsFromSameQ > 4*chunk_size){
-      // std::cout<<"1Same queue dequeue"<<std::endl;
-      if(((p.maxPrio>>delta)-(p.minPrio>>delta))<16
-         && ((double)p.pushesLastPeriod/((double)((p.maxPrio>>delta)-(p.minPrio>>delta))))> 4*chunk_size){ // this is a check to make sure we are also pushing with the same frequency end of execution
-        // std::cout<<"Same queue dequeue "<<p.ctr<<" "<<masterLog.size()<<std::endl;
-        // std::cout<<((p.maxPrio>>delta)-(p.minPrio>>delta))<<std::endl;
-        double diff = ((p.maxPrio>>delta)-(p.minPrio>>delta))>=1 ? ((p.maxPrio>>delta)-(p.minPrio>>delta)) : 1;
-        double xx = 16 / diff;
-        std::cout<<delta<<" "<<std::floor(std::log2(xx))<<" "<<xx<<std::endl;
-        if(delta>(unsigned int)(std::floor(std::log2(xx))))
-          delta -= (unsigned int)(std::floor(std::log2(xx)));
-        else
-          delta=0;
-        std::cout<<"Delta decreased to"<<delta<<std::endl;
-
-        for (unsigned i = 1; i < Runtime::activeThreads; ++i){
-          while(current.getRemote(i)->lock.try_lock());
-        }
-
-        ERR_MSG<<"Locked everyone else"<<std::endl;
-        for(unsigned i=0; i<Runtime::activeThreads; ++i){
-
-          current.getRemote(i)->sinceLastFix=0;
-          current.getRemote(i)->slowPopsLastPeriod=0;
-          current.getRemote(i)->pushesLastPeriod=0;
-          current.getRemote(i)->priosLastPeriod=0;
-          current.getRemote(i)->maxPrioDiffLastPeriod=0;
-
-          current.getRemote(i)->minPrio = std::numeric_limits<Index>::max();
-          current.getRemote(i)->maxPrio = std::numeric_limits<Index>::min();
-          // current.getRemote(i)->lock.unlock();
-        }
-
-        for (unsigned i = 1; i < Runtime::activeThreads; ++i){
-          current.getRemote(i)->lock.unlock();
-        }
-        p.ctr++;
-      }
-      p.popsFromSameQ=0;
-    }
-    */
-
     CTy* C = p.current;
     if (BlockPeriod && (BlockPeriod < 0 || (p.numPops++ & ((1ull<<BlockPeriod)-1) == 0)))
       return slowPop(p);
 
     Galois::optional<value_type> retval;
     if (C && (retval = C->pop())) {
-      p.popsFromSameQ++;
-      p.lock.unlock();
+      adaptive.popped(true);
       return retval;
     }
-    // serif remove it back
-    // p.popsFromSameQ=0;
     // Slow path
     return slowPop(p);
   }
@@ -1,11 +1,16 @@
 #ifndef GALOIS_ADAPTIVE_SMQ_H
 #define GALOIS_ADAPTIVE_SMQ_H
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdlib>
+#include <functional>
 #include <memory>
 #include <vector>
 
+#include "Galois/Runtime/PerThreadStorage.h"
+#include "Galois/Runtime/Support.h"
 #include "StealingQueue.h"
 #include "Heap.h"
 #include "StealingMultiQueue.h"
@@ -32,7 +37,7 @@ struct HeapWithStealBufferAdap {
   static T dummy;
   DAryHeap<T, Compare, D> heap;
 
-  HeapWithStealBufferAdap(): version(0) {
+  HeapWithStealBufferAdap(): filled(0), version(0) {
     stealBuffer.fill(dummy);
   }
 
@@ -108,15 +113,14 @@ struct HeapWithStealBufferAdap {
   //! Called when the elements from the previous epoch are empty.
   T fillBuffer(size_t elementsNumber) {
     if (heap.empty()) return dummy;
-    static thread_local size_t prevFillNum = STEAL_NUM;
     size_t curFillNum = 0;
     for (; curFillNum < elementsNumber && !heap.empty(); curFillNum++) {
       stealBuffer[curFillNum] = heap.extractMin();
     }
-    for (size_t j = curFillNum; j < prevFillNum; j++) {
+    for (size_t j = curFillNum; j < filled; j++) {
       stealBuffer[j] = dummy;
     }
-    prevFillNum = curFillNum;
+    filled = curFillNum;
     version.fetch_add(1, std::memory_order_acq_rel);
     return stealBuffer[0];
   }
@@ -157,6 +161,8 @@ private:
   }
 
   std::array<T, STEAL_NUM> stealBuffer;
+  // Number of elements put into the buffer by the last fill.
+  size_t filled;
   // Represents epoch & stolen flag
   // version mod 2 = 0  -- element is stolen
   // version mod 2 = 1  -- can steal
@@ -169,128 +175,133 @@ size_t STEAL_NUM,
 size_t D>
 T HeapWithStealBufferAdap<T, Compare, STEAL_NUM, D>::dummy;
 
-template<typename T,
-typename Comparer,
+/**
+ * StealingMultiQueue, which tunes the steal probability and the number
+ * of elements to put into the stealing buffer for every thread during the run.
+ *
+ * Both parameters are driven by a multiplicative-increase/decrease controller
+ * with a dead band, so they settle once the measured ratios are in the band:
+ *  - steal probability: if the buffers of other threads often contain better
+ *    elements than ours, we process worse elements than we could, so the
+ *    thread steals twice as often; if they rarely do, it steals twice as rarely;
+ *  - buffer fill size: if the thread often finds empty buffers when it steals,
+ *    the buffers are drained faster than they are filled, so the fill size
+ *    is doubled; if it rarely does, the fill size is halved.
+ *
+ * The initial values are taken from StealingMultiQueueParams.
+ *
+ * @tparam T Type of the elements.
+ * @tparam Comparer Elements comparator.
+ * @tparam Concurrent if the implementation should be concurrent
+ */
+template<typename T = int,
+typename Comparer = std::greater<int>,
 bool Concurrent = true>
 class AdaptiveStealingMultiQueue {
 private:
-  //! Number of reports needed to update the number of elements for stealing.
-  static const size_t BUFF_REPORT_CNT = 16;
-  //! Number of reports needed to update stealing probability.
+  //! Number of steal attempts needed to update the fill size.
+  static const size_t BUFF_REPORT_CNT = 64;
+  //! Number of comparisons needed to update stealing probability.
   static const size_t PROB_REPORT_CNT = 1024;
 
   //! Size of stealing buffers, which is the maximum steal batch.
   static const size_t STEAL_BUFFER_SIZE = 16;
-  //! Initial buffer fill size.
-  static const size_t INIT_BUFFER_FILL = 16;
-  //! Initial stealing probability.
-  static const size_t INIT_STEAL_PROB = 8;
+  //! Bounds of the stealing probability, a thread steals with 1 / stealProb.
+  static const size_t MIN_STEAL_PROB = 1;
+  static const size_t MAX_STEAL_PROB = 1024;
+
+  //! Dead band of the ratio of comparisons where the element of
+  //! the other thread was better, in percents.
+  static const size_t OTHER_BETTER_LOW = 10;
+  static const size_t OTHER_BETTER_HIGH = 50;
+  //! Dead band of the ratio of steal attempts which found
+  //! an empty buffer, in percents.
+  static const size_t EMPTY_LOW = 10;
+  static const size_t EMPTY_HIGH = 50;
+
   typedef HeapWithStealBufferAdap<T, Comparer, STEAL_BUFFER_SIZE, 4> Heap;
   std::unique_ptr<Galois::Runtime::LL::CacheLineStorage<Heap>[]> heaps;
-  std::unique_ptr<Galois::Runtime::LL::CacheLineStorage<std::vector<T>>[]> stealBuffers;
   Comparer compare;
   const size_t nQ;
 
   struct PerThread {
-    //! Buffer for stolen elements.
-    T stolen[STEAL_BUFFER_SIZE];
+    //! Elements stolen from other threads.
+    StolenElements<T> stolen;
 
-    size_t stealProb = INIT_STEAL_PROB;
-    size_t stealSize = INIT_BUFFER_FILL;
+    size_t stealProb;
+    size_t stealSize;
 
-    // We wanted to steal
-    size_t stealAttemptsNum = 0;
-    // We tried to steal
-    size_t otherMinLessNum = 0;
-    size_t stealReportId = 0;
+    // Comparisons of the local min with the min of the other buffer
+    size_t comparedNum = 0;
+    // The element of the other thread was better
+    size_t otherBetterNum = 0;
 
-    size_t emptyNum = 0;
+    // Steal attempts
     size_t tryNum = 0;
-    size_t emptyReportId = 0;
+    // Found an empty buffer
+    size_t emptyNum = 0;
 
+    // Controller decisions, reported when the worklist is destroyed
+    size_t probIncreased = 0;
+    size_t probDecreased = 0;
+    size_t sizeIncreased = 0;
+    size_t sizeDecreased = 0;
+
+    PerThread(size_t initProb, size_t initSize):
+        stealProb(std::min(std::max(initProb, MIN_STEAL_PROB), MAX_STEAL_PROB)),
+        stealSize(std::min(std::max<size_t>(initSize, 1), STEAL_BUFFER_SIZE)) {
+      stolen.elements.resize(STEAL_BUFFER_SIZE);
+    }
 
     void reportBetterPer(size_t ourBetter, size_t otherBetter) {
-      stealAttemptsNum += ourBetter + otherBetter;
-      otherMinLessNum += otherBetter;
-      stealReportId++;
-      if (stealReportId >= PROB_REPORT_CNT) {
+      comparedNum += ourBetter + otherBetter;
+      otherBetterNum += otherBetter;
+      if (comparedNum >= PROB_REPORT_CNT) {
         updateProbability();
-        clearProbStats();
+        comparedNum = 0;
+        otherBetterNum = 0;
       }
     }
 
     void reportEmptyPer(size_t empty, size_t total) {
       emptyNum += empty;
       tryNum += total;
-      emptyReportId++;
-      if (emptyReportId >= BUFF_REPORT_CNT) {
+      if (tryNum >= BUFF_REPORT_CNT) {
         updateSize();
-        clearEmptyStats();
+        tryNum = 0;
+        emptyNum = 0;
       }
     }
 
     void updateSize() {
-      size_t size = 0;
-      if (emptyNum * 100 <= tryNum * 30) {
-        size = 1;
-        *size1 += 1;
-      } else if (emptyNum * 100 <= tryNum * 60) {
-        size = 2;
-        *size2 += 1;
-      } else if (emptyNum * 100 <= tryNum * 90) {
-        size = 8;
-        *size8 += 1;
-      } else {
-        size = 16;
-        *size16 += 1;
+      if (emptyNum * 100 > tryNum * EMPTY_HIGH && stealSize < STEAL_BUFFER_SIZE) {
+        stealSize = std::min(stealSize * 2, STEAL_BUFFER_SIZE);
+        sizeIncreased++;
+      } else if (emptyNum * 100 < tryNum * EMPTY_LOW && stealSize > 1) {
+        stealSize /= 2;
+        sizeDecreased++;
       }
-      stealSize = size;
     }
 
     void updateProbability() {
-      size_t newProb = 0;
-      if (otherMinLessNum * 100 <= stealAttemptsNum * 5) {
-        newProb = 32;
-        *prob32 += 1;
-      } else if (otherMinLessNum * 100 <= stealAttemptsNum * 20) {
-        newProb = 16;
-        *prob16 += 1;
-      } else if (otherMinLessNum * 100 <= stealAttemptsNum * 80) {
-        newProb = 8;
-        *prob8 += 1;
-      } else if (otherMinLessNum * 100 <= stealAttemptsNum * 90) {
-        newProb = 4;
-        *prob4 += 1;
-      } else {
-        newProb = 2;
-        *prob2 += 1;
+      if (otherBetterNum * 100 > comparedNum * OTHER_BETTER_HIGH &&
+          stealProb > MIN_STEAL_PROB) {
+        stealProb = std::max(stealProb / 2, MIN_STEAL_PROB);
+        probIncreased++;
+      } else if (otherBetterNum * 100 < comparedNum * OTHER_BETTER_LOW &&
+                 stealProb < MAX_STEAL_PROB) {
+        stealProb = std::min(stealProb * 2, MAX_STEAL_PROB);
+        probDecreased++;
       }
-      stealProb = newProb;
-    }
-
-    void clearProbStats() {
-      stealAttemptsNum = 0;
-      otherMinLessNum = 0;
-      stealReportId = 0;
-    }
-
-    void clearEmptyStats() {
-      tryNum = 0;
-      emptyNum = 0;
-      emptyReportId = 0;
     }
   };
 
   Runtime::PerThreadStorage<PerThread> threadStorage;
+  ThreadRandom rng;
 
   //! Thread local random.
   uint32_t random() {
-    static thread_local uint32_t x =
-        std::chrono::system_clock::now().time_since_epoch().count() % 16386 + 1;
-    x ^= x << 13;
-    x ^= x >> 17;
-    x ^= x << 5;
-    return x;
+    return rng();
   }
 
   size_t rand_heap() {
@@ -299,20 +310,18 @@ private:
 
   //! Tries to steal from a random queue.
   //! Repeats if failed because of a race.
-  Galois::optional<T> trySteal() {
-    static thread_local size_t tId = Galois::Runtime::LL::getTID();
-    auto& local = heaps[tId].data;
-    T localMin = heaps[tId].data.getMinWriter(threadStorage.getLocal()->stealSize);
+  Galois::optional<T> trySteal(size_t tId, PerThread* local) {
+    T localMin = heaps[tId].data.getMinWriter(local->stealSize);
     bool nextIterNeeded = true;
     size_t ourBetterCnt = 0;
     size_t otherBetterCnt = 0;
     size_t emptyCnt = 0;
     size_t stealAttemptCnt = 0;
     while (nextIterNeeded) {
-      stealAttemptCnt++;
-      nextIterNeeded = false;
       auto randId = rand_heap();
       if (randId == tId) continue;
+      nextIterNeeded = false;
+      stealAttemptCnt++;
       Heap* randH = &heaps[randId].data;
       auto randMin = randH->getBufferMin(nextIterNeeded);
       if (randH->isDummy(randMin)) {
@@ -322,106 +331,63 @@ private:
       }
       if (Heap::isDummy(localMin) || compare(localMin, randMin)) {
         otherBetterCnt++;
-        T* stolenBuff = threadStorage.getLocal()->stolen;
-        const auto stolen = randH->trySteal(nextIterNeeded, stolenBuff);
+        auto& buffer = local->stolen;
+        const auto stolen = randH->trySteal(nextIterNeeded, buffer.elements.data());
         if (stolen > 0) {
-          auto& buffer = stealBuffers[tId].data;
-          for (size_t i = 1; i < stolen; i++) {
-            buffer.push_back(stolenBuff[i]);
-          }
-          std::reverse(buffer.begin(), buffer.end());
-          threadStorage.getLocal()->reportBetterPer(ourBetterCnt, otherBetterCnt);
-          threadStorage.getLocal()->reportEmptyPer(emptyCnt, stealAttemptCnt);
-          return threadStorage.getLocal()->stolen[0];
-        } 
+          buffer.next = 1;
+          buffer.size = stolen;
+          local->reportBetterPer(ourBetterCnt, otherBetterCnt);
+          local->reportEmptyPer(emptyCnt, stealAttemptCnt);
+          return buffer.elements[0];
+        }
       } else {
         ourBetterCnt++;
       }
     }
-    threadStorage.getLocal()->reportBetterPer(ourBetterCnt, otherBetterCnt);
-    threadStorage.getLocal()->reportEmptyPer(emptyCnt, stealAttemptCnt);
+    local->reportBetterPer(ourBetterCnt, otherBetterCnt);
+    local->reportEmptyPer(emptyCnt, stealAttemptCnt);
     return Galois::optional<T>();
   }
 
   //! Fills steal buffer if it is empty.
-  void fillBufferIfNeeded() {
-    static thread_local size_t tId = Galois::Runtime::LL::getTID();
+  void fillBufferIfNeeded(size_t tId, PerThread* local) {
     auto& heap = heaps[tId].data;
-    PerThread* local = threadStorage.getLocal();
     if (heap.isBufferStolen()) {
       heap.fillBuffer(local->stealSize);
     }
   }
 
 public:
-  static Galois::Statistic* size1;
-  static Galois::Statistic* size2;
-  static Galois::Statistic* size8;
-  static Galois::Statistic* size16;
-  static Galois::Statistic* prob2;
-  static Galois::Statistic* prob4;
-  static Galois::Statistic* prob8;
-  static Galois::Statistic* prob16;
-  static Galois::Statistic* prob32;
-
-  void initStatistic(Galois::Statistic*& st, std::string const& name) {
-    if (st == nullptr)
-      st = new Galois::Statistic(name);
-  }
-
-  AdaptiveStealingMultiQueue() : nQ(Galois::getActiveThreads()) {
+  AdaptiveStealingMultiQueue() :
+      nQ(Galois::getActiveThreads()),
+      threadStorage(StealingMultiQueueParams::stealProb(),
+                    StealingMultiQueueParams::stealBatchSize()) {
     memset(reinterpret_cast<void*>(&Heap::dummy), 0xff, sizeof(Heap::dummy));
     heaps = std::make_unique<Galois::Runtime::LL::CacheLineStorage<Heap>[]>(nQ);
-    stealBuffers = std::make_unique<Galois::Runtime::LL::CacheLineStorage<std::vector<T>>[]>(nQ);
-
-    initStatistic(size1, "size1");
-    initStatistic(size2, "size2");
-    initStatistic(size8, "size8");
-    initStatistic(size16, "size16");
-    initStatistic(prob2, "prob2");
-    initStatistic(prob4, "prob4");
-    initStatistic(prob8, "prob8");
-    initStatistic(prob16, "prob16");
-    initStatistic(prob32, "prob32");
-  }
-
-  void deleteStatistic(Galois::Statistic*& st, std::ofstream& out) {
-    if (st != nullptr) {
-      out << "," << getStatVal(st);
-      delete st;
-      st = nullptr;
-    }
   }
 
+  //! Reports the decisions of the controllers and the final parameters.
   ~AdaptiveStealingMultiQueue() {
-    auto exists = true; // std::filesystem::exists("asmq_stats.csv");
-    std::ofstream out("asmq_stats.csv", std::ios::app);
-    if (!exists) {
-      out << "threads,s1,s2,s8,s16,p2,p4,p8,p16,p32" << std::endl;
+    size_t probIncreased = 0, probDecreased = 0;
+    size_t sizeIncreased = 0, sizeDecreased = 0;
+    size_t probSum = 0, sizeSum = 0;
+    for (size_t i = 0; i < nQ; i++) {
+      PerThread* local = threadStorage.getRemote(i);
+      probIncreased += local->probIncreased;
+      probDecreased += local->probDecreased;
+      sizeIncreased += local->sizeIncreased;
+      sizeDecreased += local->sizeDecreased;
+      probSum += local->stealProb;
+      sizeSum += local->stealSize;
     }
-    out << nQ;
-    deleteStatistic(size1, out);
-    deleteStatistic(size2, out);
-    deleteStatistic(size8, out);
-    deleteStatistic(size16, out);
-    deleteStatistic(prob2, out);
-    deleteStatistic(prob4, out);
-    deleteStatistic(prob8, out);
-    deleteStatistic(prob16, out);
-    deleteStatistic(prob32, out);
-
-    out << std::endl;
-    out.close();
-  }
-
-  uint64_t getStatVal(Galois::Statistic* value) {
-    uint64_t stat = 0;
-    for (unsigned x = 0; x < Galois::Runtime::activeThreads; ++x)
-      stat += value->getValue(x);
-    return stat;
+    Galois::Runtime::reportStat(nullptr, "AsmqStealProbIncreased", probIncreased);
+    Galois::Runtime::reportStat(nullptr, "AsmqStealProbDecreased", probDecreased);
+    Galois::Runtime::reportStat(nullptr, "AsmqStealSizeIncreased", sizeIncreased);
+    Galois::Runtime::reportStat(nullptr, "AsmqStealSizeDecreased", sizeDecreased);
+    Galois::Runtime::reportStat(nullptr, "AsmqAvgStealProb", probSum / nQ);
+    Galois::Runtime::reportStat(nullptr, "AsmqAvgStealSize", sizeSum / nQ);
   }
 
-
   typedef T value_type;
 
   //! Change the concurrency flag.
@@ -444,9 +410,13 @@ public:
     return push(rp.first, rp.second);
   }
 
+  void push(const T& val) {
+    push(&val, &val + 1);
+  }
+
   template<typename Iter>
   unsigned int push(Iter b, Iter e) {
-    static thread_local size_t tId = Galois::Runtime::LL::getTID();
+    const size_t tId = Galois::Runtime::LL::getTID();
     if (b == e) return 0;
     unsigned int pushedNum = 0;
     Heap* heap = &heaps[tId].data;
@@ -454,82 +424,36 @@ public:
       heap->heap.push(*b++);
       pushedNum++;
     }
-    fillBufferIfNeeded();
+    fillBufferIfNeeded(tId, threadStorage.getLocal());
     return pushedNum;
   }
 
   Galois::optional<T> pop() {
-    static thread_local size_t tId = Galois::Runtime::LL::getTID();
+    const size_t tId = Galois::Runtime::LL::getTID();
+    PerThread* local = threadStorage.getLocal();
     Galois::optional<T> emptyResult;
-    auto& buffer = stealBuffers[tId].data;
-    if (!buffer.empty()) {
-      auto val = buffer.back();
-      buffer.pop_back();
-      fillBufferIfNeeded();
+    if (!local->stolen.empty()) {
+      auto val = local->stolen.pop();
+      fillBufferIfNeeded(tId, local);
       return val;
     }
 
     // rand == 0 -- try to steal
     // otherwise, pop locally
-    if (nQ > 1 && random() % (threadStorage.getLocal()->stealProb) == 0) {
-      Galois::optional<T> stolen = trySteal();
+    if (nQ > 1 && random() % local->stealProb == 0) {
+      Galois::optional<T> stolen = trySteal(tId, local);
       if (stolen.is_initialized()) return stolen;
     }
-    auto minVal = heaps[tId].data.extractMin(threadStorage.getLocal()->stealSize, threadStorage.getLocal()->stolen);
+    auto minVal = heaps[tId].data.extractMin(local->stealSize, local->stolen.elements.data());
     if (minVal.is_initialized()) return minVal;
 
     // Our heap is empty
-    return nQ == 1 ? emptyResult : trySteal();
+    return nQ == 1 ? emptyResult : trySteal(tId, local);
   }
 };
 
 GALOIS_WLCOMPILECHECK(AdaptiveStealingMultiQueue)
 
-template<typename T,
-typename Comparer,
-bool Concurrent> Statistic* AdaptiveStealingMultiQueue<
-T, Comparer, Concurrent>::size1;
-
-template<typename T,
-typename Comparer,
-bool Concurrent> Statistic* AdaptiveStealingMultiQueue<
-T, Comparer, Concurrent>::size2;
-
-template<typename T,
-typename Comparer,
-bool Concurrent> Statistic* AdaptiveStealingMultiQueue<
-T, Comparer, Concurrent>::size8;
-
-template<typename T,
-typename Comparer,
-bool Concurrent> Statistic* AdaptiveStealingMultiQueue<
-T, Comparer, Concurrent>::size16;
-
-template<typename T,
-typename Comparer,
-bool Concurrent> Statistic* AdaptiveStealingMultiQueue<
-T, Comparer, Concurrent>::prob2;
-
-template<typename T,
-typename Comparer,
-bool Concurrent> Statistic* AdaptiveStealingMultiQueue<
-T, Comparer, Concurrent>::prob4;
-
-template<typename T,
-typename Comparer,
-bool Concurrent> Statistic* AdaptiveStealingMultiQueue<
-T, Comparer, Concurrent>::prob8;
-
-template<typename T,
-typename Comparer,
-bool Concurrent> Statistic* AdaptiveStealingMultiQueue<
-T, Comparer, Concurrent>::prob16;
-
-template<typename T,
-typename Comparer,
-bool Concurrent> Statistic* AdaptiveStealingMultiQueue<
-T, Comparer, Concurrent>::prob32;
-
 } // namespace WorkList
 } // namespace Galois
 
@@ -0,0 +1,251 @@
+/** Lock-free directory of priority bins -*- C++ -*-
+ * @file
+ * @section License
+ *
+ * Galois, a framework to exploit amorphous data-parallelism in irregular
+ * programs.
+ *
+ * Copyright (C) 2013, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ *
+ * @section Description
+ *
+ * Radix tree from integer priorities to the bins of OrderedByIntegerMetric,
+ * which threads read and extend without locks.
+ */
+#ifndef GALOIS_WORKLIST_BINDIRECTORY_H
+#define GALOIS_WORKLIST_BINDIRECTORY_H
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace Galois {
+namespace WorkList {
+
+/**
+ * Concurrent radix tree from integer priorities to bins. Every level is
+ * indexed by the next BITS bits of the priority, from the high ones, so
+ * a lookup takes a fixed number of loads and an in-order walk visits the
+ * bins by increasing priority. New nodes and bins are installed by CAS.
+ *
+ * Retiring a subtree replaces its slots by tombstones before unlinking it,
+ * so that a concurrent install into it fails and retries from the root.
+ * The retired bins and nodes are handed to the caller, which frees them,
+ * once no thread can reach them any more.
+ *
+ * @tparam Index integral priority
+ * @tparam Bin type of the bins
+ * @tparam BITS log2 of the fanout of the nodes
+ */
+template<typename Index, typename Bin, unsigned BITS = 8>
+class BinDirectory {
+  static_assert(std::is_integral<Index>::value, "Priorities must be integral");
+
+  typedef typename std::make_unsigned<Index>::type Key;
+
+  static const unsigned KEY_BITS = sizeof(Key) * 8;
+  static const unsigned LEVELS = (KEY_BITS + BITS - 1) / BITS;
+  static const unsigned FANOUT = 1u << BITS;
+  static const unsigned ROOT_FANOUT = 1u << (KEY_BITS - (LEVELS - 1) * BITS);
+
+public:
+  //! Inner node or leaf, the slots of a leaf keep bins.
+  struct Node {
+    std::atomic<void*> slots[FANOUT];
+
+    Node() {
+      for (auto& s : slots)
+        s.store(nullptr, std::memory_order_relaxed);
+    }
+  };
+
+private:
+  std::atomic<void*> root[ROOT_FANOUT];
+
+  static void* tomb() {
+    return reinterpret_cast<void*>(uintptr_t(1));
+  }
+
+  static bool live(void* p) {
+    return p && p != tomb();
+  }
+
+  //! Maps priorities to keys of the same order.
+  static Key toKey(Index i) {
+    const Key k = static_cast<Key>(i);
+    return std::is_signed<Index>::value ? k ^ (Key(1) << (KEY_BITS - 1)) : k;
+  }
+
+  static Index toIndex(Key k) {
+    return static_cast<Index>(std::is_signed<Index>::value ? k ^ (Key(1) << (KEY_BITS - 1)) : k);
+  }
+
+  static unsigned slotOf(Key k, unsigned level) {
+    return (k >> (level * BITS)) & (FANOUT - 1);
+  }
+
+  static unsigned fanout(unsigned level) {
+    return level == LEVELS - 1 ? ROOT_FANOUT : FANOUT;
+  }
+
+  //! Slot of the bin with key `k`, creates the missing nodes on the way.
+  //! Returns null, if the way crosses a retired subtree.
+  std::atomic<void*>* binSlot(Key k) {
+    std::atomic<void*>* slots = root;
+    for (unsigned l = LEVELS - 1; l > 0; --l) {
+      std::atomic<void*>& s = slots[slotOf(k, l)];
+      void* n = s.load(std::memory_order_acquire);
+      if (!n) {
+        Node* fresh = new Node();
+        if (s.compare_exchange_strong(n, fresh, std::memory_order_acq_rel))
+          n = fresh;
+        else
+          delete fresh;
+      }
+      if (n == tomb())
+        return nullptr;
+      slots = static_cast<Node*>(n)->slots;
+    }
+    return &slots[slotOf(k, 0)];
+  }
+
+  template<typename F>
+  bool findIn(std::atomic<void*>* slots, unsigned level, Key start, bool bounded, Key prefix, F& f) const {
+    const unsigned first = bounded ? slotOf(start, level) : 0;
+    for (unsigned s = first, e = fanout(level); s < e; ++s) {
+      void* n = slots[s].load(std::memory_order_acquire);
+      if (!live(n))
+        continue;
+      const Key key = prefix | (Key(s) << (level * BITS));
+      if (level == 0) {
+        if (f(toIndex(key), static_cast<Bin*>(n)))
+          return true;
+      } else if (findIn(static_cast<Node*>(n)->slots, level - 1, start, bounded && s == first, key, f)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //! Replaces all the slots of the node by tombstones.
+  void tombstone(Node* node, unsigned level, std::vector<Bin*>& bins, std::vector<Node*>& nodes) {
+    for (auto& s : node->slots) {
+      void* n = s.exchange(tomb(), std::memory_order_acq_rel);
+      if (!live(n))
+        continue;
+      if (level == 0) {
+        bins.push_back(static_cast<Bin*>(n));
+      } else {
+        tombstone(static_cast<Node*>(n), level - 1, bins, nodes);
+        nodes.push_back(static_cast<Node*>(n));
+      }
+    }
+  }
+
+  void retireIn(std::atomic<void*>* slots, unsigned level, Key frontier, Key prefix,
+                std::vector<Bin*>& bins, std::vector<Node*>& nodes) {
+    for (unsigned s = 0, e = fanout(level); s < e; ++s) {
+      const Key lo = prefix | (Key(s) << (level * BITS));
+      if (lo >= frontier)
+        return;
+      void* n = slots[s].load(std::memory_order_acquire);
+      if (!live(n))
+        continue;
+      if (level == 0) {
+        slots[s].store(nullptr, std::memory_order_release);
+        bins.push_back(static_cast<Bin*>(n));
+      } else if (lo + ((Key(1) << (level * BITS)) - 1) < frontier) {
+        tombstone(static_cast<Node*>(n), level - 1, bins, nodes);
+        slots[s].store(nullptr, std::memory_order_release);
+        nodes.push_back(static_cast<Node*>(n));
+      } else {
+        retireIn(static_cast<Node*>(n)->slots, level - 1, frontier, lo, bins, nodes);
+      }
+    }
+  }
+
+  void freeIn(std::atomic<void*>* slots, unsigned level) {
+    for (unsigned s = 0, e = fanout(level); s < e; ++s) {
+      void* n = slots[s].load(std::memory_order_relaxed);
+      if (level > 0 && live(n)) {
+        freeIn(static_cast<Node*>(n)->slots, level - 1);
+        delete static_cast<Node*>(n);
+      }
+    }
+  }
+
+public:
+  BinDirectory() {
+    for (auto& s : root)
+      s.store(nullptr, std::memory_order_relaxed);
+  }
+
+  BinDirectory(const BinDirectory&) = delete;
+  BinDirectory& operator=(const BinDirectory&) = delete;
+
+  ~BinDirectory() {
+    freeIn(root, LEVELS - 1);
+  }
+
+  //! Bin of the priority, null if there is none.
+  Bin* get(Index i) const {
+    const Key k = toKey(i);
+    const std::atomic<void*>* slots = root;
+    for (unsigned l = LEVELS - 1; l > 0; --l) {
+      void* n = slots[slotOf(k, l)].load(std::memory_order_acquire);
+      if (!live(n))
+        return nullptr;
+      slots = static_cast<Node*>(n)->slots;
+    }
+    void* b = slots[slotOf(k, 0)].load(std::memory_order_acquire);
+    return live(b) ? static_cast<Bin*>(b) : nullptr;
+  }
+
+  //! Installs the bin, unless the priority has one already. Returns the
+  //! bin of the priority.
+  Bin* install(Index i, Bin* bin) {
+    const Key k = toKey(i);
+    while (true) {
+      std::atomic<void*>* s = binSlot(k);
+      if (!s)
+        continue;
+      void* n = nullptr;
+      if (s->compare_exchange_strong(n, bin, std::memory_order_acq_rel))
+        return bin;
+      if (n != tomb())
+        return static_cast<Bin*>(n);
+    }
+  }
+
+  //! Calls `f(index, bin)` for the bins from the priority `start` on, by
+  //! increasing priority, until it returns true.
+  template<typename F>
+  bool findFrom(Index start, F f) const {
+    return findIn(const_cast<std::atomic<void*>*>(root), LEVELS - 1, toKey(start), true, 0, f);
+  }
+
+  /**
+   * Unlinks the bins below the priority `frontier` and the nodes, which
+   * keep no other bins. Retiring threads have to be serialized.
+   */
+  void retireBelow(Index frontier, std::vector<Bin*>& bins, std::vector<Node*>& nodes) {
+    retireIn(root, LEVELS - 1, toKey(frontier), 0, bins, nodes);
+  }
+};
+
+} // end namespace WorkList
+} // end namespace Galois
+
+#endif
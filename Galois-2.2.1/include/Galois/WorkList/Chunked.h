@@ -35,6 +35,24 @@
 namespace Galois {
 namespace WorkList {
 
+/**
+ * Runtime parameters of the chunked worklists, they are read when a
+ * worklist is constructed.
+ */
+struct ChunkedParams {
+  //! Items per chunk, capped by the ChunkSize of the worklist, which
+  //! chunks are allocated with. 0 -- ChunkSize.
+  static unsigned& chunkSize() {
+    static unsigned value = 0;
+    return value;
+  }
+
+  //! Items per chunk of a worklist with the given ChunkSize.
+  static unsigned effective(unsigned max) {
+    return chunkSize() && chunkSize() < max ? chunkSize() : max;
+  }
+};
+
 //This overly complex specialization avoids a pointer indirection for non-distributed WL when accessing PerLevel
 template<bool, template<typename> class PS, typename TQ>
 struct squeue {
@@ -63,7 +81,10 @@ struct squeue<false, PS, TQ> {
   int size() { return 0; }
 };
 
-//! Common functionality to all chunked worklists
+/**
+ * Common functionality to all chunked worklists. Chunks keep ChunkSize
+ * items, unless ChunkedParams::chunkSize() caps them at runtime.
+ */
 template<typename T, template<typename, bool> class QT, bool Distributed, template<typename> class DistStore, bool IsStack, int ChunkSize, bool Concurrent>
 struct ChunkedMaster : private boost::noncopyable {
   template<bool _concurrent>
@@ -91,6 +112,8 @@ private:
   squeue<Concurrent, Runtime::PerThreadStorage, p> data;
   squeue<Distributed, DistStore, LevelItem> Q;
   unsigned long activeQ;
+  //! Items per chunk.
+  const unsigned limit;
 
   Chunk* mkChunk() {
     *mkChunks+=1;
@@ -146,13 +169,13 @@ private:
   template<typename... Args>
   T* emplacei(p& n, Args&&... args)  {
     T* retval = 0;
-    if (n.next && (retval = n.next->emplace_back(std::forward<Args>(args)...)))
+    if (n.next && n.next->size() < limit && (retval = n.next->emplace_back(std::forward<Args>(args)...)))
       return retval;
     if (n.next)
       pushChunk(n.next);
     n.next = mkChunk();
     retval = n.next->emplace_back(std::forward<Args>(args)...);
-    if (ChunkSize == 1) {
+    if (limit == 1) {
       pushChunk(n.next);
       n.next = 0;
     }
@@ -168,14 +191,14 @@ public:
 #else
   static Statistic *qPopFast, *qPopFastCyc, *qPopLocal, *qPopLocalCyc, *qPopRemote, *qPopRemoteCyc, *qEmpty, *qEmptyCyc, *mkChunks, *pushedChunks, *popedChunks;
   static Runtime::LL::SimpleLock<true> statLock;
+  //! Number of live worklists sharing the statistics.
+  static unsigned statUsers;
 #endif
 
   void init_qstats(std::string id = "(NULL)") {
 #ifndef PER_CHUNK_STATS
-    if (qPopFast)
-      return;
-
     statLock.lock();
+    ++statUsers;
     if (!qPopFast) {
 #endif
       qPopFast = new Statistic("qPopFast", id);
@@ -196,11 +219,11 @@ public:
 #endif
   }
 
-  ChunkedMaster() : heap(sizeof(Chunk)) {
+  ChunkedMaster() : heap(sizeof(Chunk)), limit(ChunkedParams::effective(ChunkSize)) {
     init_qstats();
   }
 
-  ChunkedMaster(int qid) : heap(sizeof(Chunk)) {
+  ChunkedMaster(int qid) : heap(sizeof(Chunk)), limit(ChunkedParams::effective(ChunkSize)) {
     if (getenv("OBIM_PRIO_STATS")) {
 #ifndef PER_CHUNK_STATS
       GALOIS_DIE("need to define PER_CHUNK_STATS for OBIM_PRIO_STATS");
@@ -213,10 +236,8 @@ public:
 
   ~ChunkedMaster() {
 #ifndef PER_CHUNK_STATS
-    if (!qPopFast)
-      return;
     statLock.lock();
-    if (qPopFast) {
+    if (--statUsers == 0 && qPopFast) {
 #endif
       delete qPopFast;  qPopFast = 0;
       delete qPopFastCyc;  qPopFastCyc = 0;
@@ -408,6 +429,9 @@ Statistic* ChunkedMaster<T, QT, Distributed, DistStore, IsStack, ChunkSize, Conc
 template<typename T, template<typename, bool> class QT, bool Distributed, template<typename> class DistStore, bool IsStack, int ChunkSize, bool Concurrent>
 Runtime::LL::SimpleLock<true> ChunkedMaster<T, QT, Distributed, DistStore, IsStack, ChunkSize, Concurrent>::statLock;
 
+template<typename T, template<typename, bool> class QT, bool Distributed, template<typename> class DistStore, bool IsStack, int ChunkSize, bool Concurrent>
+unsigned ChunkedMaster<T, QT, Distributed, DistStore, IsStack, ChunkSize, Concurrent>::statUsers;
+
 template<typename T, template<typename, bool> class QT, bool Distributed, template<typename> class DistStore, bool IsStack, int ChunkSize, bool Concurrent>
 Statistic* ChunkedMaster<T, QT, Distributed, DistStore, IsStack, ChunkSize, Concurrent>::qEmptyCyc;
 
@@ -0,0 +1,111 @@
+#ifndef GALOIS_WORKLIST_KLSM_H
+#define GALOIS_WORKLIST_KLSM_H
+
+#include "Galois/optional.h"
+#include "k_lsm/k_lsm.h"
+
+#include <algorithm>
+#include <boost/utility.hpp>
+#include <climits>
+#include <cstddef>
+
+namespace Galois {
+namespace WorkList {
+
+/**
+ * Runtime parameters of the KLSM.
+ *
+ * They are used by the instances which have `Rlx` set to 0, and are read
+ * when the worklist is constructed. Thus, they should be set before the
+ * loop starts, e.g. from the command line.
+ */
+struct KLSMParams {
+  //! Relaxation k: a pop returns one of the k + 1 smallest elements of
+  //! the shared component or of the local component of the thread. The
+  //! pivots of the k-LSM need k >= 2, smaller values are raised to 2.
+  static size_t& k() {
+    static size_t value = 256;
+    return value;
+  }
+};
+
+/**
+ * k-LSM relaxed priority queue of Wimmer et al. Every thread inserts into
+ * its own LSM of the distributed component (bound to its Galois thread id),
+ * whose blocks move to the shared component, once they reach the size of
+ * about k / 2. A pop takes the smaller of the local minimum and one of the
+ * k + 1 smallest elements of the shared component, or spies the elements
+ * of another thread, if both are empty.
+ *
+ * The relaxation of the instances with `Rlx` set to 0 is shared by all of
+ * them and set from KLSMParams::k() on construction, so such worklists
+ * must not be used by concurrent loops with different k.
+ *
+ * @tparam T type of the elements
+ * @tparam Indexer priority of an element, smaller is popped first,
+ *                 `unsigned long r = indexer(item)`
+ * @tparam Rlx relaxation k, 0 -- KLSMParams::k(), 1 is raised to 2 as
+ *             the runtime one
+ */
+template<typename T,
+         typename Indexer,
+         int Rlx = 0,
+         bool Concurrent = true
+>
+class KLSM : private boost::noncopyable {
+  kpq::k_lsm<unsigned long, T, (Rlx == kpq::DYNAMIC_RLX || Rlx >= 2) ? Rlx : 2> pq;
+  Indexer indexer;
+
+public:
+  KLSM() {
+    if (Rlx == kpq::DYNAMIC_RLX) {
+      kpq::dynamic_relaxation() = std::max<size_t>(2, std::min<size_t>(KLSMParams::k(), INT_MAX));
+    }
+  }
+
+  typedef T value_type;
+
+  //! Change the concurrency flag.
+  template<bool _concurrent>
+  struct rethread {
+    typedef KLSM<T, Indexer, Rlx, _concurrent> type;
+  };
+
+  //! Change the type the worklist holds.
+  template<typename _T>
+  struct retype {
+    typedef KLSM<_T, Indexer, Rlx, Concurrent> type;
+  };
+
+  template<typename RangeTy>
+  unsigned int push_initial(const RangeTy &range) {
+    auto rp = range.local_pair();
+    return push(rp.first, rp.second);
+  }
+
+  template<typename Iter>
+  unsigned int push(Iter b, Iter e) {
+    unsigned int pushedNum = 0;
+    for (; b != e; ++b, ++pushedNum) {
+      push(*b);
+    }
+    return pushedNum;
+  }
+
+  void push(const T& val) {
+    pq.insert(static_cast<unsigned long>(indexer(val)), val);
+  }
+
+  Galois::optional<T> pop() {
+    T val;
+    if (pq.delete_min(val)) {
+      return val;
+    }
+    return Galois::optional<T>();
+  }
+};
+
+} // namespace WorkList
+} // namespace Galois
+
+#endif // GALOIS_WORKLIST_KLSM_H
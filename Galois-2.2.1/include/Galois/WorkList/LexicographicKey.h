@@ -0,0 +1,89 @@
+#ifndef GALOIS_WORKLIST_LEXICOGRAPHICKEY_H
+#define GALOIS_WORKLIST_LEXICOGRAPHICKEY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+namespace Galois {
+namespace WorkList {
+
+/**
+ * Lexicographic priority of several unsigned levels, e.g. (level, weight)
+ * or (height, excess), packed into one unsigned integer: the first level
+ * takes the most significant bits. Packed keys are compared with one
+ * instruction and can be used as `Prior` of the multiqueues and as
+ * indices of OBIM.
+ *
+ * A value, which does not fit into its bits, is saturated, so the order
+ * is kept up to the ties of the too large values.
+ *
+ * The levels take 63 bits at most: the packed lock and minimum word of
+ * HeapWithLock keeps 63 bits of the minimum and reserves 2^63 - 1 for an
+ * empty heap. If the levels take 63 or 32 bits, the key with all the
+ * levels saturated is reserved as the empty priority, see
+ * PriorityKeyTraits.
+ *
+ * @tparam BITS Number of bits of every level, 63 in total at most.
+ */
+template<unsigned... BITS>
+struct LexicographicKey {
+  static const unsigned LEVELS = sizeof...(BITS);
+
+  static constexpr unsigned bits(unsigned level) {
+    const unsigned b[] = {BITS...};
+    return b[level];
+  }
+
+  static constexpr unsigned totalBits() {
+    unsigned sum = 0;
+    for (unsigned i = 0; i < LEVELS; i++) {
+      sum += bits(i);
+    }
+    return sum;
+  }
+
+  static_assert(LEVELS > 0 && totalBits() <= 63, "Levels do not fit into 63 bits");
+
+  //! Integer keeping the levels.
+  typedef typename std::conditional<totalBits() <= 32, uint32_t, uint64_t>::type type;
+
+  //! Maximal value of the level.
+  static constexpr uint64_t maxOf(unsigned level) {
+    return (uint64_t(1) << bits(level)) - 1;
+  }
+
+  //! Position of the lowest bit of the level.
+  static constexpr unsigned shiftOf(unsigned level) {
+    unsigned shift = 0;
+    for (unsigned i = level + 1; i < LEVELS; i++) {
+      shift += bits(i);
+    }
+    return shift;
+  }
+
+  //! Packs the levels, the most significant one goes first.
+  template<typename... Levels>
+  static type pack(Levels... levels) {
+    static_assert(sizeof...(Levels) == LEVELS, "Wrong number of levels");
+    const uint64_t values[] = {static_cast<uint64_t>(levels)...};
+    uint64_t key = 0;
+    for (unsigned i = 0; i < LEVELS; i++) {
+      const uint64_t value = std::min(values[i], maxOf(i));
+      key = i == 0 ? value : (key << bits(i)) | value;
+    }
+    return static_cast<type>(key);
+  }
+
+  //! Value of the level in the key.
+  template<unsigned LEVEL>
+  static uint64_t get(type key) {
+    static_assert(LEVEL < LEVELS, "No such level");
+    return (static_cast<uint64_t>(key) >> shiftOf(LEVEL)) & maxOf(LEVEL);
+  }
+};
+
+} // namespace WorkList
+} // namespace Galois
+
+#endif // GALOIS_WORKLIST_LEXICOGRAPHICKEY_H
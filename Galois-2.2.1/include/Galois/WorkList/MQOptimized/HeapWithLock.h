@@ -1,64 +1,331 @@
 #ifndef GALOIS_HEAPWITHLOCK_H
 #define GALOIS_HEAPWITHLOCK_H
 
+#include "Galois/Runtime/mm/Mem.h"
 #include "../WorkListHelpers.h"
+#include "../PackedHeap.h"
+#include "../PriorityTraits.h"
 
-#include <boost/heap/d_ary_heap.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <vector>
 
 
 namespace Galois {
 namespace WorkList {
 
+/**
+ * Lock and minimum of a heap packed into one 64-bit word, so that reading
+ * the minimum of a queue and locking it touch the same word. The lowest bit
+ * is the lock, the others keep the minimum, which saturates at 2^63 - 1,
+ * the value of an empty heap. The empty priority is encoded the same way.
+ *
+ * Used for unsigned integral priorities.
+ */
+template<typename Prior>
+class PackedLockMin {
+  static const uint64_t LOCKED = 1;
+  static const uint64_t EMPTY = std::numeric_limits<uint64_t>::max() >> 1;
+
+  std::atomic<uint64_t> word{EMPTY << 1};
+
+  static uint64_t encode(Prior const& p) {
+    return PriorityKeyTraits<Prior>::isEmpty(p) ? EMPTY : std::min<uint64_t>(p, EMPTY);
+  }
+
+public:
+  typedef uint64_t Seen;
+
+  bool try_lock() {
+    uint64_t w = word.load(std::memory_order_relaxed);
+    if (w & LOCKED)
+      return false;
+    return word.compare_exchange_strong(w, w | LOCKED, std::memory_order_acquire,
+                                        std::memory_order_relaxed);
+  }
+
+  void lock() {
+    while (!try_lock()) {
+      Runtime::LL::asmPause();
+    }
+  }
+
+  void unlock() {
+    word.fetch_and(~LOCKED, std::memory_order_release);
+  }
+
+  Prior getMin() const {
+    const uint64_t m = word.load(std::memory_order_acquire) >> 1;
+    return m == EMPTY ? PriorityKeyTraits<Prior>::empty() : static_cast<Prior>(m);
+  }
+
+  Seen seen() const {
+    return word.load(std::memory_order_acquire);
+  }
+
+  //! Sets the minimum of the locked heap, fails if it has been
+  //! lowered since `seen`.
+  bool replaceMin(Seen seen, Prior const& p) {
+    return word.compare_exchange_strong(seen, (encode(p) << 1) | LOCKED);
+  }
+
+  //! Lowers the minimum to `p`, if it is larger.
+  void lowerMin(Prior const& p) {
+    const uint64_t m = encode(p);
+    uint64_t w = word.load();
+    while ((w >> 1) > m &&
+           !word.compare_exchange_weak(w, (m << 1) | (w & LOCKED))) {}
+  }
+};
+
+template<typename Prior>
+const uint64_t PackedLockMin<Prior>::LOCKED;
+
+template<typename Prior>
+const uint64_t PackedLockMin<Prior>::EMPTY;
+
+/**
+ * Lock and minimum of a heap kept in separate words, used for the
+ * priorities, which do not fit into PackedLockMin. The atomic minimum of
+ * 128-bit priorities is implemented by libatomic, which galois links.
+ */
+template<typename Prior>
+class SplitLockMin {
+  Runtime::LL::SimpleLock<true> _lock;
+  std::atomic<Prior> min;
+
+  static bool isLess(Prior const& p1, Prior const& p2) {
+    return !PriorityKeyTraits<Prior>::isEmpty(p1)
+           && (PriorityKeyTraits<Prior>::isEmpty(p2) || p1 < p2);
+  }
+
+public:
+  typedef Prior Seen;
+
+  SplitLockMin() : min(PriorityKeyTraits<Prior>::empty()) {}
+
+  bool try_lock() {
+    return _lock.try_lock();
+  }
+
+  void lock() {
+    _lock.lock();
+  }
+
+  void unlock() {
+    _lock.unlock();
+  }
+
+  Prior getMin() const {
+    return min.load(std::memory_order_acquire);
+  }
+
+  Seen seen() const {
+    return min.load(std::memory_order_acquire);
+  }
+
+  bool replaceMin(Seen seen, Prior const& p) {
+    return min.compare_exchange_strong(seen, p);
+  }
+
+  void lowerMin(Prior const& p) {
+    Prior m = min.load();
+    while (isLess(p, m) &&
+           !min.compare_exchange_weak(m, p)) {}
+  }
+};
+
+/**
+ * Fixed size array of elements, each on its own cache line. Unlike an
+ * array from `make_unique`, it is aligned as CacheLineStorage requires.
+ */
+template<typename T>
+class CacheLineArray {
+  typedef Runtime::LL::CacheLineStorage<T> Storage;
+
+  Storage* items;
+  const size_t size;
+
+public:
+  explicit CacheLineArray(size_t size) : size(size) {
+    void* p = nullptr;
+    if (posix_memalign(&p, alignof(Storage), size * sizeof(Storage)) != 0) {
+      throw std::bad_alloc();
+    }
+    items = static_cast<Storage*>(p);
+    for (size_t i = 0; i < size; i++) {
+      new (&items[i]) Storage();
+    }
+  }
+
+  CacheLineArray(CacheLineArray const&) = delete;
+  CacheLineArray& operator=(CacheLineArray const&) = delete;
+
+  ~CacheLineArray() {
+    for (size_t i = 0; i < size; i++) {
+      items[i].~Storage();
+    }
+    free(items);
+  }
+
+  Storage& operator[](size_t i) {
+    return items[i];
+  }
+};
+
 /**
  * Lockable heap structure.
  *
- * @tparam T type of stored elements
- * @tparam Comparer callable defining ordering for objects of type `T`
- * @tparam Prior Type of T's priority
- * @tparam D Arity of a sequential heap
- * Its `operator()` returns `true` iff the first argument should follow the second one.
+ * A thread, which does not want to wait for the lock, can defer its
+ * elements to the heap instead. They are kept in a lock-free list and
+ * merged into the heap by the next lock holder, the minimum of the heap
+ * accounts for them at once. A lock holder publishing the minimum merges
+ * again, if elements have been deferred meanwhile, so that it does not
+ * overwrite the minimum lowered for them. The deferred elements are copied
+ * into fixed size blocks of the Galois allocator, so `T` should be default
+ * constructible.
+ *
+ * @tparam T type of stored elements, ordered by their priorities
+ * @tparam Prior Type of T's priority, see PriorityTraits. The empty
+ * priority of PriorityKeyTraits is the minimum of an empty heap.
+ * @tparam D Arity of a sequential heap, see PackedDAryHeap.
  */
 template <typename T,
-          typename Comparer,
           typename Prior = unsigned long,
           size_t D = 4>
 struct HeapWithLock {
-  typedef boost::heap::d_ary_heap<T, boost::heap::arity<D>,
-          boost::heap::compare<Comparer>> DAryHeap;
+  typedef PackedDAryHeap<T, Prior, D> DAryHeap;
+
+private:
+  typedef typename std::conditional<
+      std::is_integral<Prior>::value && std::is_unsigned<Prior>::value && sizeof(Prior) <= 8,
+      PackedLockMin<Prior>, SplitLockMin<Prior>>::type LockMin;
+
+  //! Block of deferred elements, a push of more elements takes several.
+  struct Deferred {
+    static const size_t CAPACITY = 16;
+
+    T elements[CAPACITY];
+    size_t count;
+    Deferred* next;
+  };
+
+  LockMin lockMin;
+  std::atomic<Deferred*> deferred{nullptr};
+  Runtime::MM::FixedSizeAllocator deferredAlloc{sizeof(Deferred)};
+
+  Deferred* newDeferred() {
+    Deferred* d = new (deferredAlloc.allocate(sizeof(Deferred))) Deferred;
+    d->count = 0;
+    d->next = nullptr;
+    return d;
+  }
+
+  void deleteDeferred(Deferred* d) {
+    d->~Deferred();
+    deferredAlloc.deallocate(d);
+  }
+
+  //! Merges the deferred elements into the locked heap.
+  void mergeDeferred() {
+    if (!deferred.load(std::memory_order_relaxed)) return;
+    Deferred* d = deferred.exchange(nullptr);
+    while (d) {
+      heap.push(d->elements, d->elements + d->count);
+      Deferred* next = d->next;
+      deleteDeferred(d);
+      d = next;
+    }
+  }
+
+public:
   DAryHeap heap;
-  // Dummy element for setting min when the heap is empty
-  static Prior dummy;
 
-  HeapWithLock() : min(dummy) {}
+  HeapWithLock() = default;
+
+  ~HeapWithLock() {
+    Deferred* d = deferred.load(std::memory_order_relaxed);
+    while (d) {
+      Deferred* next = d->next;
+      deleteDeferred(d);
+      d = next;
+    }
+  }
 
   //! Non-blocking lock.
   bool try_lock() {
-    return _lock.try_lock();
+    if (!lockMin.try_lock())
+      return false;
+    mergeDeferred();
+    return true;
   }
 
   //! Blocking lock.
   void lock() {
-    _lock.lock();
+    lockMin.lock();
+    mergeDeferred();
   }
 
   //! Unlocks the queue.
   void unlock() {
-    _lock.unlock();
+    lockMin.unlock();
   }
 
   Prior getMin() {
-    return min.load(std::memory_order_acquire);
+    return lockMin.getMin();
   }
 
-  static bool isMinDummy(Prior const& value) {
-    return value == dummy;
+  //! Prefetches the minimum for a following getMin.
+  void prefetchMin() const {
+    __builtin_prefetch(&lockMin);
   }
 
+  //! Checks whether the minimum is of an empty heap.
+  static bool isMinEmpty(Prior const& value) {
+    return PriorityKeyTraits<Prior>::isEmpty(value);
+  }
+
+  //! Publishes the minimum of the locked heap, taking the elements
+  //! deferred in the meantime.
   void updateMin() {
-    return min.store(
-    heap.size() > 0 ? heap.top().prior() : dummy,
-    std::memory_order_release
-    );
+    while (true) {
+      const typename LockMin::Seen seen = lockMin.seen();
+      mergeDeferred();
+      if (!lockMin.replaceMin(seen, heap.size() > 0 ? PriorityTraits<T>::prior(heap.top())
+                                                    : PriorityKeyTraits<Prior>::empty()))
+        continue;
+      // A deferral linked after the merge may not have lowered the
+      // minimum, if it was below its elements. Any later one sees the
+      // published minimum.
+      if (!deferred.load())
+        return;
+    }
+  }
+
+  //! Passes the elements to the next lock holder, can be called
+  //! without the lock.
+  template<typename Iter>
+  void deferPush(Iter b, Iter e) {
+    if (b == e) return;
+    Prior min = PriorityTraits<T>::prior(*b);
+    Deferred* first = newDeferred();
+    Deferred* last = first;
+    for (; b != e; ++b) {
+      if (last->count == Deferred::CAPACITY) {
+        last->next = newDeferred();
+        last = last->next;
+      }
+      last->elements[last->count++] = *b;
+      min = std::min<Prior>(min, PriorityTraits<T>::prior(*b));
+    }
+    // The blocks are linked at once, a lock holder merges all of them.
+    last->next = deferred.load(std::memory_order_relaxed);
+    while (!deferred.compare_exchange_weak(last->next, first)) {}
+    lockMin.lowerMin(min);
   }
 
   T extractMin() {
@@ -71,21 +338,22 @@ struct HeapWithLock {
     heap.push(task);
   }
 
+  template<typename Iter>
+  void push(Iter b, Iter e) {
+    heap.push(b, e);
+  }
+
+  //! Moves all the elements to the end of `out`.
+  void extractAll(std::vector<T>& out) {
+    mergeDeferred();
+    heap.extractAll(out);
+  }
+
   bool empty() const {
     return heap.empty();
   }
-
-private:
-  Runtime::LL::SimpleLock<true> _lock;
-  std::atomic<Prior> min;
 };
 
-template<typename T,
-         typename Compare,
-         typename Prior,
-         size_t D>
-Prior HeapWithLock<T, Compare, Prior, D>::dummy;
-
 } // namespace WorkList
 } // namespace Galois
 
@@ -1,13 +1,6 @@
 #ifndef GALOIS_MQOPTIMIZEDINCLUDE_H
 #define GALOIS_MQOPTIMIZEDINCLUDE_H
 
-#include "MultiQueueProbProb.h"
-#include "MultiQueueProbLocal.h"
-#include "MultiQueueLocalProb.h"
-#include "MultiQueueLocalLocal.h"
-#include "MultiQueueProbProbNuma.h"
-#include "MultiQueueProbLocalNuma.h"
-#include "MultiQueueLocalProbNuma.h"
-#include "MultiQueueLocalLocalNuma.h"
+#include "PolicyMultiQueue.h"
 
 #endif //GALOIS_MQOPTIMIZEDINCLUDE_H
@@ -0,0 +1,100 @@
+#ifndef GALOIS_NUMAQUEUEMAP_H
+#define GALOIS_NUMAQUEUEMAP_H
+
+#include "Galois/Runtime/ll/HWTopo.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Galois {
+namespace WorkList {
+
+/**
+ * Runtime parameters of the NUMA-aware worklists.
+ *
+ * They are used by the instances which have `LOCAL_NUMA_W` set to 0,
+ * and are read when the worklist is constructed.
+ */
+struct NumaParams {
+  //! Weight of a queue on the local node, a remote queue has weight 1.
+  static size_t& localWeight() {
+    static size_t value = 1;
+    return value;
+  }
+};
+
+/**
+ * Maps the queues of a multiqueue to the NUMA nodes of the threads
+ * owning them and selects random queues preferring the local node.
+ *
+ * The nodes are taken from the HW topology, so any number of packages
+ * and any thread numbering is supported. Thread `tId` owns the queues
+ * `[tId * C, (tId + 1) * C)`.
+ */
+class NumaQueueMap {
+  //! Number of queues per thread.
+  const size_t C;
+  //! Weight of a local queue.
+  const size_t localWeight;
+  //! Node of every thread.
+  std::vector<size_t> threadNode;
+  //! Queue ids grouped by node.
+  std::vector<size_t> queues;
+  //! Queues of node `i` are `queues[nodeBegin[i]..nodeBegin[i + 1])`.
+  std::vector<size_t> nodeBegin;
+
+public:
+  NumaQueueMap(size_t nT, size_t C, size_t localWeight) :
+      C(C), localWeight(std::max<size_t>(localWeight, 1)), threadNode(nT) {
+    size_t nodes = 0;
+    for (size_t tId = 0; tId < nT; tId++) {
+      threadNode[tId] = Galois::Runtime::LL::getPackageForThread(tId);
+      nodes = std::max(nodes, threadNode[tId] + 1);
+    }
+    nodeBegin.assign(nodes + 1, 0);
+    for (size_t tId = 0; tId < nT; tId++) {
+      nodeBegin[threadNode[tId] + 1] += C;
+    }
+    for (size_t node = 0; node < nodes; node++) {
+      nodeBegin[node + 1] += nodeBegin[node];
+    }
+    queues.resize(nT * C);
+    std::vector<size_t> next(nodeBegin.begin(), nodeBegin.end() - 1);
+    for (size_t tId = 0; tId < nT; tId++) {
+      for (size_t i = 0; i < C; i++) {
+        queues[next[threadNode[tId]]++] = tId * C + i;
+      }
+    }
+  }
+
+  //! Node of the thread.
+  size_t nodeByTID(size_t tId) const {
+    return threadNode[tId];
+  }
+
+  //! Node of the thread owning the queue.
+  size_t nodeByQID(size_t qId) const {
+    return threadNode[qId / C];
+  }
+
+  //! Random queue, a local queue is `localWeight` times more likely
+  //! than a remote one.
+  size_t randQueue(size_t tId, uint32_t random) const {
+    const size_t node = threadNode[tId];
+    const size_t localBegin = nodeBegin[node];
+    const size_t localCnt = nodeBegin[node + 1] - localBegin;
+    const size_t localTotal = localCnt * localWeight;
+    size_t r = random % (localTotal + queues.size() - localCnt);
+    if (r < localTotal) {
+      return queues[localBegin + r / localWeight];
+    }
+    r -= localTotal;
+    return queues[r < localBegin ? r : r + localCnt];
+  }
+};
+
+} // namespace WorkList
+} // namespace Galois
+
+#endif // GALOIS_NUMAQUEUEMAP_H
@@ -0,0 +1,632 @@
+#ifndef GALOIS_POLICYMULTIQUEUE_H
+#define GALOIS_POLICYMULTIQUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include "Galois/Runtime/PerThreadStorage.h"
+#include "HeapWithLock.h"
+#include "NumaQueueMap.h"
+
+namespace Galois {
+namespace WorkList {
+
+/**
+ * Policies of PolicyMultiQueue, the meaning of the parameter depends
+ * on the policy.
+ *
+ * Insert policies:
+ * - RANDOM_INSERT pushes every element onto a random queue.
+ * - TEMPORAL_INSERT pushes a sequence of elements onto one queue and
+ *   changes it with 1 / insertParam probability after every element.
+ * - BATCHING_INSERT collects elements in a thread local buffer and pushes
+ *   insertParam of them onto a random queue at once. The buffer is pushed
+ *   earlier, when the thread pops or when an element is better than the
+ *   last one the thread has popped, so that the delay of an element is bounded.
+ *
+ * Delete policies:
+ * - TWO_CHOICE_DELETE pops from the best of MultiQueueParams::popChoices()
+ *   random queues.
+ * - TEMPORAL_DELETE pops a sequence of elements from one queue and
+ *   changes it with 1 / deleteParam probability before every pop.
+ * - BATCHING_DELETE takes deleteParam elements from the best of the
+ *   random queues into a thread local buffer.
+ */
+struct MultiQueuePolicy {
+  enum Insert { RANDOM_INSERT, TEMPORAL_INSERT, BATCHING_INSERT };
+  enum Delete { TWO_CHOICE_DELETE, TEMPORAL_DELETE, BATCHING_DELETE };
+
+  Insert insert = TEMPORAL_INSERT;
+  size_t insertParam = 8;
+  Delete remove = TEMPORAL_DELETE;
+  size_t deleteParam = 8;
+};
+
+/**
+ * Runtime parameters of PolicyMultiQueue.
+ *
+ * They are read when the worklist is constructed.
+ */
+struct MultiQueueParams {
+  static MultiQueuePolicy& policy() {
+    static MultiQueuePolicy value;
+    return value;
+  }
+
+  //! Number of queues per thread of the worklists with C = 0.
+  static size_t& queuesPerThread() {
+    static size_t value = 2;
+    return value;
+  }
+
+  //! Maximal number of queues per thread, if it is not 0, the number
+  //! of queues changes between 1 and this number per thread by the
+  //! contention, starting with C queues per thread.
+  static size_t& maxQueuesPerThread() {
+    static size_t value = 0;
+    return value;
+  }
+
+  //! Number of random queues compared by a pop, from 2 to 8.
+  static size_t& popChoices() {
+    static size_t value = 2;
+    return value;
+  }
+
+  //! Number of pops, which compare the same queues. The queues are
+  //! sampled again earlier, if the best one is locked or empty.
+  static size_t& popStickiness() {
+    static size_t value = 1;
+    return value;
+  }
+
+  //! If the minimums of the sampled queues should be prefetched.
+  static bool& prefetchChoices() {
+    static bool value = false;
+    return value;
+  }
+};
+
+/**
+ * MultiQueue optimized variant, which selects the queues for `push`
+ * and `pop` by the runtime policies, see MultiQueuePolicy.
+ * The policies can be changed while the worklist is in use, the elements
+ * buffered by the previous policy are not lost.
+ *
+ * While some thread fails to pop, the others push their buffers onto the
+ * queues after every operation, so that no elements are hidden in the
+ * thread local buffers when the work runs out.
+ *
+ * The number of queues is elastic, if MultiQueueParams::maxQueuesPerThread()
+ * is set: a queue is added, when the threads often fail to lock the queues,
+ * and the last queue is removed, when they often find the queues empty.
+ * The elements of a removed queue are moved to the others. The number of
+ * queues of the NUMA variant is fixed.
+ *
+ * A pusher does not wait for a locked queue, it defers the elements to
+ * the lock holder, see HeapWithLock.
+ *
+ * Provides efficient pushing of range of elements only.
+ *
+ * @tparam T type of elements
+ * @tparam Comparer comparator for elements of type `T`, kept for the worklist
+ * interface. The queues order the elements by PriorityTraits, which should agree with it.
+ * @tparam C parameter for queues number, 0 means MultiQueueParams::queuesPerThread()
+ * @tparam Prior Type of T's priority, see PriorityTraits. Need to support < operator.
+ * @tparam Numa if the random queues should be selected on the NUMA node of the thread
+ * more likely. A queue is not kept by the temporal policies if it is remote.
+ * @tparam LOCAL_NUMA_W Weight of a queue on the local NUMA node, 0 means NumaParams::localWeight()
+ * @tparam Concurrent if the implementation should be concurrent
+ */
+template<typename T,
+         typename Comparer,
+         size_t C = 2,
+         typename Prior = unsigned long,
+         bool Numa = false,
+         size_t LOCAL_NUMA_W = 0,
+         bool Concurrent = true>
+class PolicyMultiQueue {
+private:
+  typedef HeapWithLock<T, Prior, 8> Heap;
+
+  //! State of a thread.
+  struct ThreadState {
+    size_t tId = 0;
+    uint32_t x = 1;
+    //! Queues kept by the temporal policies.
+    size_t pushQ = 0;
+    size_t popQ = 0;
+    //! Elements collected by BATCHING_INSERT.
+    std::vector<T> pushBuffer;
+    //! Elements taken by BATCHING_DELETE, the best one is the last.
+    std::vector<T> popBuffer;
+    //! If the last pop has failed.
+    bool idle = false;
+    //! Priority of the last popped element, the estimate of the best
+    //! priority in the queues.
+    Prior lastPrior = PriorityKeyTraits<Prior>::empty();
+    //! Queues compared by the pops.
+    size_t choices[8] = {};
+    //! Number of pops left, which compare the same queues.
+    size_t stickyPops = 0;
+    //! Contention statistics since the last change of the queue number.
+    size_t lockAttempts = 0;
+    size_t lockFails = 0;
+    size_t pops = 0;
+    size_t emptyPops = 0;
+
+    //! Thread local random.
+    uint32_t random() {
+      x ^= x << 13;
+      x ^= x >> 17;
+      x ^= x << 5;
+      return x;
+    }
+  };
+
+  //! Lock attempts, after which a thread checks the contention.
+  static const size_t ADAPT_WINDOW = 1024;
+  //! A queue is added if more than 1 / GROW_FAILS of the lock attempts fail.
+  static const size_t GROW_FAILS = 8;
+  //! A queue is removed if more than 1 / SHRINK_EMPTY of the pops find
+  //! an empty queue, while less than 1 / SHRINK_FAILS of the lock attempts fail.
+  static const size_t SHRINK_EMPTY = 4;
+  static const size_t SHRINK_FAILS = 32;
+  static const size_t MAX_CHOICES = 8;
+
+  Runtime::PerThreadStorage<ThreadState> states;
+  //! Total number of threads.
+  const size_t nT;
+  //! Initial number of queues per thread.
+  const size_t c;
+  //! Number of allocated queues.
+  const size_t nQ;
+  CacheLineArray<Heap> heaps;
+  //! If the number of queues changes.
+  const bool elastic;
+  const NumaQueueMap numaMap;
+  //! Number of queues in use, the first ones are used.
+  std::atomic<size_t> activeQ;
+  //! Held by the thread changing the number of queues.
+  Runtime::LL::SimpleLock<true> resizeLock;
+
+  std::atomic<MultiQueuePolicy::Insert> insertPolicy;
+  std::atomic<size_t> insertParam;
+  std::atomic<MultiQueuePolicy::Delete> deletePolicy;
+  std::atomic<size_t> deleteParam;
+  //! Number of queues compared by a pop.
+  const size_t popChoices;
+  const size_t popStickiness;
+  const bool prefetchChoices;
+  //! Number of threads, which have failed to pop.
+  std::atomic<size_t> idleThreads{0};
+
+  ThreadState& state() {
+    return *states.getLocal();
+  }
+
+  inline size_t rand_heap(ThreadState& st) {
+    if (Numa) {
+      return numaMap.randQueue(st.tId, st.random());
+    }
+    return st.random() % activeQ.load(std::memory_order_relaxed);
+  }
+
+  //! Locks the queue, if it is still in use.
+  bool tryLockActive(ThreadState& st, size_t q) {
+    st.lockAttempts++;
+    Heap* heap = &heaps[q].data;
+    if (!heap->try_lock()) {
+      st.lockFails++;
+      return false;
+    }
+    if (q >= activeQ.load(std::memory_order_acquire)) {
+      // Removed after the queue has been selected
+      heap->unlock();
+      return false;
+    }
+    return true;
+  }
+
+  //! Queue to keep for the temporal policies.
+  inline size_t keep_heap(ThreadState& st, size_t q) {
+    if (Numa && numaMap.nodeByQID(q) != numaMap.nodeByTID(st.tId)) {
+      return rand_heap(st);
+    }
+    return q;
+  }
+
+  //! Checks whether the first priority value is less.
+  bool isFirstLess(Prior const& v1, Prior const& v2) {
+    if (Heap::isMinEmpty(v1)) {
+      return false;
+    }
+    if (Heap::isMinEmpty(v2)) {
+      return true;
+    }
+    return v1 < v2;
+  }
+
+  //! Pushes the elements onto the queue, they are deferred to its lock
+  //! holder if it is locked. Fails if the queue is removed.
+  template<typename Iter>
+  bool pushOnto(ThreadState& st, size_t q, Iter b, Iter e) {
+    Heap* heap = &heaps[q].data;
+    if (tryLockActive(st, q)) {
+      heap->push(b, e);
+      heap->updateMin();
+      heap->unlock();
+      return true;
+    }
+    if (q >= activeQ.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    heap->deferPush(b, e);
+    if (q >= activeQ.load(std::memory_order_seq_cst)) {
+      // Removed meanwhile, the elements could be deferred after
+      // the queue has been drained.
+      std::vector<T> removed;
+      heap->lock();
+      heap->extractAll(removed);
+      heap->updateMin();
+      heap->unlock();
+      flush(st, removed);
+    }
+    return true;
+  }
+
+  //! Pushes the buffer onto a random queue.
+  void flush(ThreadState& st, std::vector<T>& buffer) {
+    if (buffer.empty()) return;
+    while (!pushOnto(st, rand_heap(st), buffer.begin(), buffer.end())) {}
+    buffer.clear();
+  }
+
+  template<typename Iter>
+  void pushRandom(ThreadState& st, Iter b, Iter e) {
+    for (; b != e; ++b) {
+      Iter next = std::next(b);
+      while (!pushOnto(st, rand_heap(st), b, next)) {}
+    }
+  }
+
+  template<typename Iter>
+  void pushTemporal(ThreadState& st, Iter b, Iter e, size_t changeQ) {
+    while (b != e) {
+      // The queue is changed after an element with 1 / changeQ probability.
+      Iter next = b;
+      do {
+        ++next;
+      } while (next != e && st.random() % changeQ != 0);
+      while (!pushOnto(st, st.pushQ, b, next)) {
+        st.pushQ = rand_heap(st);
+      }
+      b = next;
+      if (b != e) {
+        st.pushQ = keep_heap(st, rand_heap(st));
+      }
+    }
+  }
+
+  template<typename Iter>
+  void pushBatching(ThreadState& st, Iter b, Iter e, size_t batchSize) {
+    bool urgent = false;
+    for (; b != e; ++b) {
+      urgent |= PriorityTraits<T>::prior(*b) < st.lastPrior;
+      st.pushBuffer.push_back(*b);
+      if (st.pushBuffer.size() >= batchSize) {
+        flush(st, st.pushBuffer);
+      }
+    }
+    if (urgent) {
+      flush(st, st.pushBuffer);
+    }
+  }
+
+  //! Extracts minimum from the locked heap, the next `batch - 1`
+  //! elements go to the delete buffer.
+  T extract_min(ThreadState& st, Heap* heap, size_t batch) {
+    T result = heap->extractMin();
+    auto& buffer = st.popBuffer;
+    for (size_t i = 1; i < batch && !heap->empty(); i++) {
+      buffer.push_back(heap->extractMin());
+    }
+    std::reverse(buffer.begin(), buffer.end());
+    heap->updateMin();
+    heap->unlock();
+    return result;
+  }
+
+  //! Samples the queues to compare, distinct if there are enough.
+  void sampleChoices(ThreadState& st) {
+    const size_t active = activeQ.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < popChoices; i++) {
+      size_t q = rand_heap(st);
+      while (i < active && std::find(st.choices, st.choices + i, q) != st.choices + i) {
+        q = rand_heap(st);
+      }
+      st.choices[i] = q;
+      if (prefetchChoices) {
+        heaps[q].data.prefetchMin();
+      }
+    }
+    st.stickyPops = popStickiness;
+  }
+
+  //! Locks the best of the sampled queues.
+  size_t lockBestChoice(ThreadState& st) {
+    while (true) {
+      if (st.stickyPops == 0) {
+        sampleChoices(st);
+      }
+      st.stickyPops--;
+      size_t best = st.choices[0];
+      Prior bestMin = heaps[best].data.getMin();
+      for (size_t i = 1; i < popChoices; i++) {
+        const Prior min = heaps[st.choices[i]].data.getMin();
+        if (isFirstLess(min, bestMin)) {
+          best = st.choices[i];
+          bestMin = min;
+        }
+      }
+      if (tryLockActive(st, best))
+        return best;
+      st.stickyPops = 0;
+    }
+  }
+
+  //! Pops from the delete buffer or the queues.
+  Galois::optional<T> tryPop(ThreadState& st) {
+    static const size_t ATTEMPTS = 4;
+
+    // Retrieve an element from the buffer, it can be left
+    // by BATCHING_DELETE after the policy is changed.
+    auto& buffer = st.popBuffer;
+    if (!buffer.empty()) {
+      auto ret = buffer.back();
+      buffer.pop_back();
+      return ret;
+    }
+
+    const size_t param = deleteParam.load(std::memory_order_relaxed);
+    const MultiQueuePolicy::Delete policy = deletePolicy.load(std::memory_order_relaxed);
+    // The local queue is changed with 1 / param probability.
+    if (policy == MultiQueuePolicy::TEMPORAL_DELETE && st.random() % param > 0
+        && tryLockActive(st, st.popQ)) {
+      Heap* heap = &heaps[st.popQ].data;
+      st.pops++;
+      if (!heap->empty()) {
+        return extract_min(st, heap, 1);
+      }
+      st.emptyPops++;
+      heap->unlock();
+    }
+
+    const size_t batch = policy == MultiQueuePolicy::BATCHING_DELETE ? param : 1;
+    for (size_t i = 0; i < ATTEMPTS; i++) {
+      const size_t q = lockBestChoice(st);
+      Heap* heap = &heaps[q].data;
+      st.pops++;
+      if (!heap->empty()) {
+        if (policy == MultiQueuePolicy::TEMPORAL_DELETE) {
+          st.popQ = keep_heap(st, q);
+        }
+        return extract_min(st, heap, batch);
+      }
+      st.emptyPops++;
+      st.stickyPops = 0;
+      heap->unlock();
+    }
+    return Galois::optional<T>();
+  }
+
+  void setIdle(ThreadState& st, bool idle) {
+    if (st.idle != idle) {
+      st.idle = idle;
+      if (idle) {
+        idleThreads.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        idleThreads.fetch_sub(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  //! Changes the number of queues by the contention seen by the thread.
+  void adapt(ThreadState& st) {
+    if (!elastic || st.lockAttempts < ADAPT_WINDOW) return;
+    const size_t q = activeQ.load(std::memory_order_relaxed);
+    if (st.lockFails * GROW_FAILS > st.lockAttempts) {
+      resize(st, q, q + 1);
+    } else if (st.emptyPops * SHRINK_EMPTY > st.pops
+               && st.lockFails * SHRINK_FAILS < st.lockAttempts) {
+      resize(st, q, q - 1);
+    }
+    st.lockAttempts = st.lockFails = st.pops = st.emptyPops = 0;
+  }
+
+  //! Changes the number of queues from `expected` to `target`, unless
+  //! another thread changes it. The elements of the removed queues are
+  //! moved to the others.
+  void resize(ThreadState& st, size_t expected, size_t target) {
+    if (Numa) return;
+    target = std::min(std::max(target, nT), nQ);
+    if (target == expected || !resizeLock.try_lock()) return;
+    if (activeQ.load(std::memory_order_relaxed) != expected) {
+      resizeLock.unlock();
+      return;
+    }
+    activeQ.store(target, std::memory_order_seq_cst);
+    // Removed queues are not locked anymore by the others, except those,
+    // who have selected them before
+    std::vector<T> removed;
+    for (size_t q = target; q < expected; q++) {
+      Heap* heap = &heaps[q].data;
+      heap->lock();
+      heap->extractAll(removed);
+      heap->updateMin();
+      heap->unlock();
+    }
+    resizeLock.unlock();
+    flush(st, removed);
+  }
+
+  //! Pushes both buffers onto the queues if some thread is idle,
+  //! so that the buffered elements do not wait for their owner.
+  void publishOnIdle(ThreadState& st) {
+    if (idleThreads.load(std::memory_order_relaxed) == 0) return;
+    flush(st, st.pushBuffer);
+    flush(st, st.popBuffer);
+  }
+
+public:
+  PolicyMultiQueue() : nT(Galois::getActiveThreads()),
+      c(C != 0 ? C : std::max<size_t>(MultiQueueParams::queuesPerThread(), 1)),
+      nQ(std::max<size_t>(c, Numa ? 0 : MultiQueueParams::maxQueuesPerThread()) * nT),
+      heaps(nQ),
+      elastic(!Numa && MultiQueueParams::maxQueuesPerThread() != 0),
+      numaMap(nT, c, LOCAL_NUMA_W != 0 ? LOCAL_NUMA_W : NumaParams::localWeight()),
+      activeQ(c * nT),
+      popChoices(std::min(std::max<size_t>(MultiQueueParams::popChoices(), 2), MAX_CHOICES)),
+      popStickiness(std::max<size_t>(MultiQueueParams::popStickiness(), 1)),
+      prefetchChoices(MultiQueueParams::prefetchChoices()) {
+    const uint32_t seed = std::chrono::system_clock::now().time_since_epoch().count() % 16386;
+    for (size_t i = 0; i < nT; i++) {
+      auto& st = *states.getRemote(i);
+      st.tId = i;
+      st.x = seed + i + 1;
+      st.pushQ = rand_heap(st);
+      st.popQ = rand_heap(st);
+    }
+    setPolicy(MultiQueueParams::policy());
+  }
+
+  //! T is the value type of the WL.
+  typedef T value_type;
+
+  //! Change the concurrency flag.
+  template<bool _concurrent>
+  struct rethread {
+    typedef PolicyMultiQueue<T, Comparer, C, Prior, Numa, LOCAL_NUMA_W, _concurrent> type;
+  };
+
+  //! Change the type the worklist holds.
+  template<typename _T>
+  struct retype {
+    typedef PolicyMultiQueue<_T, Comparer, C, Prior, Numa, LOCAL_NUMA_W, Concurrent> type;
+  };
+
+  //! Changes the policies, can be called concurrently with
+  //! `push` and `pop`.
+  void setPolicy(MultiQueuePolicy const& policy) {
+    insertParam.store(std::max<size_t>(1, policy.insertParam), std::memory_order_relaxed);
+    insertPolicy.store(policy.insert, std::memory_order_relaxed);
+    deleteParam.store(std::max<size_t>(1, policy.deleteParam), std::memory_order_relaxed);
+    deletePolicy.store(policy.remove, std::memory_order_relaxed);
+  }
+
+  //! Changes the number of queues in use, can be called concurrently
+  //! with `push` and `pop`. It is between the number of threads and
+  //! the number of the allocated queues.
+  void setQueueNumber(size_t number) {
+    ThreadState& st = state();
+    size_t expected = activeQ.load(std::memory_order_relaxed);
+    while (!Numa && std::min(std::max(number, nT), nQ) != expected) {
+      resize(st, expected, number);
+      expected = activeQ.load(std::memory_order_relaxed);
+    }
+  }
+
+  //! Number of queues in use.
+  size_t queueNumber() const {
+    return activeQ.load(std::memory_order_relaxed);
+  }
+
+  //! Push a range onto the queue.
+  template<typename Iter>
+  unsigned int push(Iter b, Iter e) {
+    ThreadState& st = state();
+    const unsigned int pushNumber = std::distance(b, e);
+    const size_t param = insertParam.load(std::memory_order_relaxed);
+    switch (insertPolicy.load(std::memory_order_relaxed)) {
+    case MultiQueuePolicy::BATCHING_INSERT:
+      pushBatching(st, b, e, param);
+      break;
+    case MultiQueuePolicy::TEMPORAL_INSERT:
+      // Left by BATCHING_INSERT.
+      flush(st, st.pushBuffer);
+      pushTemporal(st, b, e, param);
+      break;
+    default:
+      flush(st, st.pushBuffer);
+      pushRandom(st, b, e);
+    }
+    publishOnIdle(st);
+    adapt(st);
+    return pushNumber;
+  }
+
+  //! Push initial range onto the queue.
+  //! Called with the same b and e on each thread.
+  template<typename RangeTy>
+  unsigned int push_initial(const RangeTy &range) {
+    auto rp = range.local_pair();
+    return push(rp.first, rp.second);
+  }
+
+  //! Pop a value from the queue.
+  Galois::optional<value_type> pop() {
+    ThreadState& st = state();
+    // Left by BATCHING_INSERT.
+    flush(st, st.pushBuffer);
+    adapt(st);
+    Galois::optional<value_type> result = tryPop(st);
+    setIdle(st, !result);
+    if (result) {
+      st.lastPrior = PriorityTraits<T>::prior(*result);
+      publishOnIdle(st);
+    }
+    return result;
+  }
+};
+
+/**
+ * PolicyMultiQueue, which selects the queues on the NUMA node
+ * of the thread more likely.
+ */
+template<typename T,
+         typename Comparer,
+         size_t C,
+         size_t LOCAL_NUMA_W,
+         typename Prior = unsigned long,
+         bool Concurrent = true>
+using PolicyMultiQueueNuma = PolicyMultiQueue<T, Comparer, C, Prior, true, LOCAL_NUMA_W, Concurrent>;
+
+/**
+ * PolicyMultiQueue, which takes the number of queues per thread and the
+ * policies from MultiQueueParams, so that they can be tuned without
+ * recompilation.
+ */
+template<typename T,
+         typename Comparer,
+         typename Prior = unsigned long,
+         bool Concurrent = true>
+using RuntimePolicyMultiQueue = PolicyMultiQueue<T, Comparer, 0, Prior, false, 0, Concurrent>;
+
+/**
+ * RuntimePolicyMultiQueue, which takes the weight of the local queues
+ * from NumaParams.
+ */
+template<typename T,
+         typename Comparer,
+         typename Prior = unsigned long,
+         bool Concurrent = true>
+using RuntimePolicyMultiQueueNuma = PolicyMultiQueue<T, Comparer, 0, Prior, true, 0, Concurrent>;
+
+} // namespace WorkList
+} // namespace Galois
+
+#endif // GALOIS_POLICYMULTIQUEUE_H
@@ -1 +0,0 @@
-#define SOCKETS_NUM 2
\ No newline at end of file
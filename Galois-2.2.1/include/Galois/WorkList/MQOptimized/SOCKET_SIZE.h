@@ -1 +0,0 @@
-#define SOCKET_SIZE 64
\ No newline at end of file
@@ -24,16 +24,19 @@
 #define GALOIS_WORKLIST_OBIM_H
 
 #include "Galois/config.h"
-#include "Galois/FlatMap.h"
 #include "Galois/Timer.h"
 #include "Galois/Runtime/PerThreadStorage.h"
+#include "Galois/WorkList/AdaptiveDelta.h"
+#include "Galois/WorkList/BinDirectory.h"
 #include "Galois/WorkList/Fifo.h"
 #include "Galois/WorkList/WorkListHelpers.h"
 
 #include "Galois/Statistic.h"
 
 #include GALOIS_CXX11_STD_HEADER(type_traits)
+#include <atomic>
 #include <limits>
+#include <vector>
 
 #include <iostream>
 
@@ -50,6 +53,25 @@ extern "C" {
 namespace Galois {
 namespace WorkList {
 
+/**
+ * Runtime parameters of OrderedByIntegerMetric, they are read when a
+ * worklist is constructed.
+ */
+struct OBIMParams {
+  //! Number of created bins, after which the bins below the current bins of
+  //! all the threads are retired. 0 keeps all the bins.
+  static unsigned& retireAfter() {
+    static unsigned value = 4096;
+    return value;
+  }
+
+  //! Merges the bins at runtime, see AdaptiveDelta.
+  static bool& adaptiveDelta() {
+    static bool value = false;
+    return value;
+  }
+};
+
 /**
  * Approximate priority scheduling. Indexer is a default-constructable class
  * whose instances conform to <code>R r = indexer(item)</code> where R is
@@ -73,6 +95,16 @@ namespace WorkList {
  * @tparam BlockPeriod Check for higher priority work every 2^BlockPeriod
  *                     iterations
  * @tparam BSP Use back-scan prevention
+ *
+ * The bins are kept in a BinDirectory, which threads look up and extend
+ * without locks. Bins below the current bins of all the threads are
+ * retired from time to time, see OBIMParams::retireAfter(). Every thread
+ * drains the retired bins into the live ones, when it moves to the next
+ * generation of bins, and a retired bin is freed, once all the threads
+ * have moved past it.
+ *
+ * With OBIMParams::adaptiveDelta(), the low bits of the indices are
+ * ignored, as many as an AdaptiveDelta controller decides at runtime.
  */
 template<class Indexer = DummyIndexer<int>, typename Container = FIFO<>,
   int BlockPeriod=0,
@@ -104,33 +136,45 @@ struct OrderedByIntegerMetric : private boost::noncopyable {
 
 private:
   typedef typename Container::template rethread<Concurrent>::type CTy;
-  typedef Galois::flat_map<Index, CTy*> LMapTy;
+  typedef BinDirectory<Index, CTy> DirTy;
   //typedef Galois::flat_map<Index, std::atomic<unsigned int>> CntrMapTy;
-  //typedef std::map<Index, CTy*> LMapTy;
+
+  //! Bins and directory nodes retired at once, threads drain the bins, when
+  //! they move to the generation.
+  struct Generation {
+    unsigned int epoch;
+    Generation* prev;
+    std::vector<CTy*> bins;
+    std::vector<typename DirTy::Node*> nodes;
+
+    Generation(unsigned int e, Generation* p): epoch(e), prev(p) { }
+  };
 
   struct perItem {
-    LMapTy local;
     //CntrMapTy counter; // for every push increase counter
     Index curIndex;
     Index scanStart;
     CTy* current;
-    unsigned int lastMasterVersion;
     unsigned int numPops;
+    Generation* gen;
+    //! Epoch of the generation, the thread has moved to.
+    std::atomic<unsigned int> epoch;
 
     perItem() :
       curIndex(std::numeric_limits<Index>::min()),
       scanStart(std::numeric_limits<Index>::min()),
-      current(0), lastMasterVersion(0), numPops(0) { }
+      current(0), numPops(0), gen(0), epoch(0) { }
   };
 
-  typedef std::deque<std::pair<Index, CTy*> > MasterLog;
-
-  // NB: Place dynamically growing masterLog after fixed-size PerThreadStorage
-  // members to give higher likelihood of reclaiming PerThreadStorage
   Runtime::PerThreadStorage<perItem> current;
-  Runtime::LL::PaddedLock<Concurrent> masterLock;
+  Runtime::LL::PaddedLock<Concurrent> retireLock;
   Galois::Timer clock;
-  MasterLog masterLog;
+  DirTy dir;
+  std::atomic<Generation*> gen;
+  std::atomic<unsigned int> created;
+  const unsigned int retireAfter;
+  const bool adaptDelta;
+  AdaptiveDelta<Index> adaptive;
 
 
   //counters per priority
@@ -138,7 +182,6 @@ private:
 
 
   Runtime::MM::FixedSizeAllocator heap;
-  std::atomic<unsigned int> masterVersion;
   Indexer indexer;
 
 
@@ -155,30 +198,81 @@ private:
     return x;
   }
 
-  bool updateLocal(perItem& p) {
-    if (p.lastMasterVersion != masterVersion.load(std::memory_order_relaxed)) {
-      //masterLock.lock();
-      for (; p.lastMasterVersion < masterVersion.load(std::memory_order_relaxed); ++p.lastMasterVersion) {
-        // XXX(ddn): Somehow the second block is better than
-        // the first for bipartite matching (GCC 4.7.2)
-#if 0
-        p.local.insert(masterLog[p.lastMasterVersion]);
-#else
-        std::pair<Index, CTy*> logEntry = masterLog[p.lastMasterVersion];
-        p.local[logEntry.first] = logEntry.second;
-        assert(logEntry.second);
-#endif
+  void freeBin(CTy* lC) {
+    lC->~CTy();
+    heap.deallocate(lC);
+  }
+
+  //! Moves the thread to the current generation. It drains the bins retired
+  //! since its last generation first, as only it can see its part of them.
+  GALOIS_ATTRIBUTE_NOINLINE
+  void syncGeneration(perItem& p) {
+    Generation* g = gen.load(std::memory_order_acquire);
+    std::vector<value_type> drained;
+    for (Generation* ii = g; ii != p.gen; ii = ii->prev) {
+      for (CTy* lC : ii->bins) {
+        while (Galois::optional<value_type> v = lC->pop())
+          drained.push_back(*v);
       }
-      //masterLock.unlock();
-      return true;
     }
-    return false;
+    p.current = 0;
+    p.gen = g;
+    p.epoch.store(g->epoch, std::memory_order_release);
+    for (auto& v : drained)
+      push_profiled(v);
+  }
+
+  //! Frees the retired bins and nodes, which no thread can reach any more.
+  //! Called with the retire lock.
+  void reclaim() {
+    unsigned int minEpoch = std::numeric_limits<unsigned int>::max();
+    for (unsigned i = 0; i < Runtime::activeThreads; ++i)
+      minEpoch = std::min(minEpoch, current.getRemote(i)->epoch.load(std::memory_order_acquire));
+    Generation* keep = gen.load(std::memory_order_relaxed);
+    while (keep->epoch > minEpoch) {
+      if (!keep->prev)
+        return;
+      keep = keep->prev;
+    }
+    for (Generation* ii = keep; ii; ) {
+      for (CTy* lC : ii->bins)
+        freeBin(lC);
+      for (auto* n : ii->nodes)
+        delete n;
+      ii->bins.clear();
+      ii->nodes.clear();
+      Generation* prev = ii->prev;
+      if (ii != keep)
+        delete ii;
+      ii = prev;
+    }
+    keep->prev = 0;
+  }
+
+  //! Retires the bins below the current bins of all the threads into a new
+  //! generation. Called with the retire lock.
+  void retireBins() {
+    Index frontier = std::numeric_limits<Index>::max();
+    for (unsigned i = 0; i < Runtime::activeThreads; ++i) {
+      perItem& o = *current.getRemote(i);
+      frontier = std::min(frontier, o.curIndex);
+      if (BSP)
+        frontier = std::min(frontier, o.scanStart);
+    }
+    Generation* old = gen.load(std::memory_order_relaxed);
+    Generation* g = new Generation(old->epoch + 1, old);
+    dir.retireBelow(frontier, g->bins, g->nodes);
+    if (g->bins.empty() && g->nodes.empty()) {
+      delete g;
+      return;
+    }
+    gen.store(g, std::memory_order_release);
+    reclaim();
   }
 
   GALOIS_ATTRIBUTE_NOINLINE
   Galois::optional<T> slowPop(perItem& p) {
     //Failed, find minimum bin
-    updateLocal(p);
     unsigned myID = Runtime::LL::getTID();
     bool localLeader = Runtime::LL::isPackageLeaderForSelf(myID);
 
@@ -193,51 +287,44 @@ private:
       }
     }
 
-    for (auto ii = p.local.lower_bound(msS), ee = p.local.end(); ii != ee; ++ii) {
-      Galois::optional<T> retval;
-      if ((retval = ii->second->pop())) {
-        p.current = ii->second;
-        p.curIndex = ii->first;
-        p.scanStart = ii->first;
-        return retval;
-      }
-    }
-    return Galois::optional<value_type>();
+    Galois::optional<T> retval;
+    dir.findFrom(msS, [&](Index i, CTy* lC) {
+      if (!(retval = lC->pop()))
+        return false;
+      p.current = lC;
+      p.curIndex = i;
+      p.scanStart = i;
+      return true;
+    });
+    return retval;
   }
 
   GALOIS_ATTRIBUTE_NOINLINE
-  CTy* slowUpdateLocalOrCreate(perItem& p, Index i) {
-    //update local until we find it or we get the write lock
-    do {
-      CTy* lC;
-      updateLocal(p);
-      if ((lC = p.local[i]))
-        return lC;
-    } while (!masterLock.try_lock());
-    //we have the write lock, update again then create
-    updateLocal(p);
-    CTy*& lC2 = p.local[i];
-    if (!lC2) {
-      lC2 = new (heap.allocate(sizeof(CTy))) CTy(i);
-      p.lastMasterVersion = masterVersion.load(std::memory_order_relaxed) + 1;
-      masterLog.push_back(std::make_pair(i, lC2));
-      masterVersion.fetch_add(1);
-      (*numberOfPris)+=1;
-      //perPriorityCntr[i]=0;
-    }
-    masterLock.unlock();
-    return lC2;
+  CTy* slowCreate(Index i) {
+    CTy* lC = new (heap.allocate(sizeof(CTy))) CTy(i);
+    CTy* installed = dir.install(i, lC);
+    if (installed != lC) {
+      //another thread has created it meanwhile
+      freeBin(lC);
+      return installed;
+    }
+    (*numberOfPris)+=1;
+    //perPriorityCntr[i]=0;
+    if (retireAfter && (created.fetch_add(1, std::memory_order_relaxed) + 1) % retireAfter == 0
+        && retireLock.try_lock()) {
+      retireBins();
+      retireLock.unlock();
+    }
+    return lC;
   }
 
-  inline CTy* updateLocalOrCreate(perItem& p, Index i) {
-    //Try local then try update then find again or else create and update the master log
+  inline CTy* getOrCreate(Index i) {
     CTy* lC;
-    if ((lC = p.local[i]))
+    if ((lC = dir.get(i)))
       return lC;
     //slowpath
-    return slowUpdateLocalOrCreate(p, i);
+    return slowCreate(i);
   }
-
 public:
   static Galois::Statistic* numberOfPris;
 #ifdef GALOIS_USE_PAPI
@@ -265,7 +352,10 @@ public:
   static Galois::Statistic* deqEventNum4;
 #endif
 #endif
-  OrderedByIntegerMetric(const Indexer& x = Indexer()): heap(sizeof(CTy)), masterVersion(0), indexer(x) {
+  OrderedByIntegerMetric(const Indexer& x = Indexer()):
+    gen(new Generation(0, 0)), created(0),
+    retireAfter(OBIMParams::retireAfter()), adaptDelta(OBIMParams::adaptiveDelta()),
+    adaptive(64), heap(sizeof(CTy)), indexer(x) {
     clock.start();
     if(numberOfPris == 0){
       numberOfPris = new Galois::Statistic("numberOfPris");
@@ -402,15 +492,21 @@ public:
   }
 
   ~OrderedByIntegerMetric() {
-    perItem& p = *current.getLocal();
-    updateLocal(p);
-    // Deallocate in LIFO order to give opportunity for simple garbage
-    // collection
+    if (adaptDelta)
+      adaptive.report("Obim");
     //Print stats for priroity counts here
-    for (auto ii = masterLog.rbegin(), ei = masterLog.rend(); ii != ei; ++ii) {
-      CTy* lC = ii->second;
-      lC->~CTy();
-      heap.deallocate(lC);
+    dir.findFrom(std::numeric_limits<Index>::min(), [this](Index, CTy* lC) {
+      freeBin(lC);
+      return false;
+    });
+    for (Generation* g = gen.load(std::memory_order_relaxed); g; ) {
+      for (CTy* lC : g->bins)
+        freeBin(lC);
+      for (auto* n : g->nodes)
+        delete n;
+      Generation* prev = g->prev;
+      delete g;
+      g = prev;
     }
 
     if(numberOfPris!=0){
@@ -541,7 +637,13 @@ public:
   inline void push_profiled(const value_type& val) {
 
     Index index = indexer(val);
+    if (adaptDelta) {
+      adaptive.pushed(index);
+      index = adaptive.binOf(index);
+    }
     perItem& p = *current.getLocal();
+    if (p.gen != gen.load(std::memory_order_relaxed))
+      syncGeneration(p);
 
     //perPriorityCntr[index].fetch_add(1);
     // Fast path
@@ -551,14 +653,16 @@ public:
     }
 
     // Slow path
-    CTy* lC = updateLocalOrCreate(p, index);
     if (BSP && index < p.scanStart)
       p.scanStart = index;
-    // Opportunistically move to higher priority work
-    if (index < p.curIndex) {
+    // Opportunistically move to higher priority work, the index is set
+    // first to keep a new bin from being retired at once
+    bool higher = index < p.curIndex;
+    if (higher)
       p.curIndex = index;
+    CTy* lC = getOrCreate(index);
+    if (higher)
       p.current = lC;
-    }
     lC->push(val);
 
   }
@@ -643,18 +747,25 @@ public:
 
     // Find a successful pop
     perItem& p = *current.getLocal();
+    if (p.gen != gen.load(std::memory_order_relaxed))
+      syncGeneration(p);
     CTy* C = p.current;
     if (BlockPeriod && (BlockPeriod < 0 || (p.numPops++ & (((1ull << BlockPeriod) - 1) == 0))))
       return slowPop(p);
 
     Galois::optional<value_type> retval;
     if (C && (retval = C->pop())) {
+      if (adaptDelta)
+        adaptive.popped(true);
       return retval;
     }
 
     // Slow path
+    if (adaptDelta)
+      adaptive.slowPop();
     Galois::optional<value_type> returnValue =  slowPop(p);
-
+    if (adaptDelta && returnValue)
+      adaptive.popped(false);
 
     return returnValue;
   }
@@ -0,0 +1,321 @@
+#ifndef GALOIS_PACKEDHEAP_H
+#define GALOIS_PACKEDHEAP_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include "PriorityTraits.h"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace Galois {
+namespace WorkList {
+
+//! Size of the cache line the packed heap layout is made for.
+static const size_t PACKED_HEAP_LINE = 64;
+
+/**
+ * Allocator returning memory aligned to PACKED_HEAP_LINE.
+ */
+template<typename T>
+struct CacheAlignedAllocator {
+  typedef T value_type;
+
+  CacheAlignedAllocator() = default;
+
+  template<typename U>
+  CacheAlignedAllocator(CacheAlignedAllocator<U> const&) {}
+
+  T* allocate(size_t n) {
+    void* p = nullptr;
+    if (posix_memalign(&p, PACKED_HEAP_LINE, n * sizeof(T)) != 0) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(p);
+  }
+
+  void deallocate(T* p, size_t) {
+    free(p);
+  }
+
+  template<typename U>
+  bool operator==(CacheAlignedAllocator<U> const&) const { return true; }
+
+  template<typename U>
+  bool operator!=(CacheAlignedAllocator<U> const&) const { return false; }
+};
+
+/**
+ * Index of the minimum among the `D` priorities of a child group,
+ * the first one is taken among equal priorities. Groups of 8 and 16
+ * unsigned 32- and 64-bit priorities are scanned with AVX2 or AVX-512
+ * if the target supports them.
+ */
+template<typename Prior, size_t D>
+struct ChildMin {
+  static size_t get(Prior const* p) {
+    size_t best = 0;
+    for (size_t k = 1; k < D; k++) {
+      if (p[k] < p[best]) best = k;
+    }
+    return best;
+  }
+};
+
+#ifdef __AVX2__
+//! Minima of unsigned integers with AVX2. There is no unsigned 64-bit
+//! comparison, so the 64-bit values are kept with the sign bit flipped.
+struct Avx2Min {
+  static __m256i load(void const* p) {
+    return _mm256_loadu_si256(static_cast<__m256i const*>(p));
+  }
+
+  static __m256i flip64(__m256i v) {
+    return _mm256_xor_si256(v, _mm256_set1_epi64x(std::numeric_limits<int64_t>::min()));
+  }
+
+  static __m256i min64(__m256i a, __m256i b) {
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+  }
+
+  //! Broadcasts the minimum of the four flipped 64-bit lanes.
+  static __m256i all64(__m256i m) {
+    m = min64(m, _mm256_permute4x64_epi64(m, 0x4e));
+    return min64(m, _mm256_shuffle_epi32(m, 0x4e));
+  }
+
+  //! Lanes of the flipped 64-bit vector equal to the minimum.
+  static unsigned mask64(__m256i v, __m256i m) {
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, m)));
+  }
+
+  //! Broadcasts the minimum of the eight 32-bit lanes.
+  static __m256i all32(__m256i m) {
+    m = _mm256_min_epu32(m, _mm256_permute2x128_si256(m, m, 1));
+    m = _mm256_min_epu32(m, _mm256_shuffle_epi32(m, 0x4e));
+    return _mm256_min_epu32(m, _mm256_shuffle_epi32(m, 0xb1));
+  }
+
+  //! Lanes of the 32-bit vector equal to the minimum.
+  static unsigned mask32(__m256i v, __m256i m) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, m)));
+  }
+};
+
+template<>
+struct ChildMin<uint32_t, 8> {
+  static size_t get(uint32_t const* p) {
+    const __m256i v = Avx2Min::load(p);
+    return __builtin_ctz(Avx2Min::mask32(v, Avx2Min::all32(v)));
+  }
+};
+#endif
+
+#ifdef __AVX512F__
+template<>
+struct ChildMin<uint32_t, 16> {
+  static size_t get(uint32_t const* p) {
+    const __m512i v = _mm512_loadu_si512(p);
+    const __m512i m = _mm512_set1_epi32(_mm512_reduce_min_epu32(v));
+    return __builtin_ctz(_mm512_cmpeq_epu32_mask(v, m));
+  }
+};
+
+template<>
+struct ChildMin<uint64_t, 8> {
+  static size_t get(uint64_t const* p) {
+    const __m512i v = _mm512_loadu_si512(p);
+    const __m512i m = _mm512_set1_epi64(_mm512_reduce_min_epu64(v));
+    return __builtin_ctz(_mm512_cmpeq_epu64_mask(v, m));
+  }
+};
+
+template<>
+struct ChildMin<uint64_t, 16> {
+  static size_t get(uint64_t const* p) {
+    const __m512i a = _mm512_loadu_si512(p);
+    const __m512i b = _mm512_loadu_si512(p + 8);
+    const __m512i m = _mm512_set1_epi64(_mm512_reduce_min_epu64(_mm512_min_epu64(a, b)));
+    return __builtin_ctz(_mm512_cmpeq_epu64_mask(a, m) |
+                         _mm512_cmpeq_epu64_mask(b, m) << 8);
+  }
+};
+#elif defined(__AVX2__)
+template<>
+struct ChildMin<uint32_t, 16> {
+  static size_t get(uint32_t const* p) {
+    const __m256i a = Avx2Min::load(p);
+    const __m256i b = Avx2Min::load(p + 8);
+    const __m256i m = Avx2Min::all32(_mm256_min_epu32(a, b));
+    return __builtin_ctz(Avx2Min::mask32(a, m) | Avx2Min::mask32(b, m) << 8);
+  }
+};
+
+template<>
+struct ChildMin<uint64_t, 8> {
+  static size_t get(uint64_t const* p) {
+    const __m256i a = Avx2Min::flip64(Avx2Min::load(p));
+    const __m256i b = Avx2Min::flip64(Avx2Min::load(p + 4));
+    const __m256i m = Avx2Min::all64(Avx2Min::min64(a, b));
+    return __builtin_ctz(Avx2Min::mask64(a, m) | Avx2Min::mask64(b, m) << 4);
+  }
+};
+
+template<>
+struct ChildMin<uint64_t, 16> {
+  static size_t get(uint64_t const* p) {
+    __m256i v[4];
+    for (size_t i = 0; i < 4; i++) {
+      v[i] = Avx2Min::flip64(Avx2Min::load(p + 4 * i));
+    }
+    const __m256i m = Avx2Min::all64(
+        Avx2Min::min64(Avx2Min::min64(v[0], v[1]), Avx2Min::min64(v[2], v[3])));
+    unsigned mask = 0;
+    for (size_t i = 0; i < 4; i++) {
+      mask |= Avx2Min::mask64(v[i], m) << (4 * i);
+    }
+    return __builtin_ctz(mask);
+  }
+};
+#endif
+
+/**
+ * Sequential d-ary min-heap, which keeps the priorities and the elements
+ * in separate arrays. Only the priorities are read while sifting. The root
+ * is stored at `D - 1`, so every child group is aligned to its size, and
+ * by default the arity is chosen so that a group fills one cache line.
+ * Groups are padded with the empty priority, so the minimum of the
+ * children is always taken over the whole group, see ChildMin.
+ *
+ * Shared by the multiqueues, so that the arity is tuned the same way
+ * for all of them.
+ *
+ * @tparam T Type of the elements, PriorityTraits gives the priority.
+ * @tparam Prior Type of the priority. Need to support < operator
+ * and PriorityKeyTraits.
+ * @tparam D Arity of the heap.
+ */
+template<typename T,
+         typename Prior,
+         size_t D = PACKED_HEAP_LINE / sizeof(Prior)>
+class PackedDAryHeap {
+  static_assert(D > 1, "Priority is too large for the packed layout");
+  static const size_t OFFSET = D - 1;
+
+  std::vector<Prior, CacheAlignedAllocator<Prior>> priors;
+  std::vector<T> elements;
+
+  static Prior sentinel() {
+    return PriorityKeyTraits<Prior>::empty();
+  }
+
+  //! Moves the hole at `index` up and puts the element there.
+  void sift_up(size_t index, Prior prior, T const& val) {
+    while (index > 0) {
+      const size_t parent = (index - 1) / D;
+      if (!(prior < priors[OFFSET + parent])) break;
+      priors[OFFSET + index] = priors[OFFSET + parent];
+      elements[index] = elements[parent];
+      index = parent;
+    }
+    priors[OFFSET + index] = prior;
+    elements[index] = val;
+  }
+
+  //! Moves the hole at `index` down and puts the element there.
+  void sift_down(size_t index, Prior prior, T const& val) {
+    const size_t size = elements.size();
+    while (D * index + 1 < size) {
+      // The group of the children starts at `D * (index + 1)`.
+      const size_t group = D * (index + 1);
+      const size_t child = group + ChildMin<Prior, D>::get(&priors[group]) - OFFSET;
+      if (!(priors[OFFSET + child] < prior)) break;
+      priors[OFFSET + index] = priors[OFFSET + child];
+      elements[index] = elements[child];
+      index = child;
+    }
+    priors[OFFSET + index] = prior;
+    elements[index] = val;
+  }
+
+public:
+  PackedDAryHeap() : priors(D, sentinel()) {}
+
+  bool empty() const {
+    return elements.empty();
+  }
+
+  size_t size() const {
+    return elements.size();
+  }
+
+  //! Minimum element in the heap. UB if the heap is empty.
+  T const& top() const {
+    return elements[0];
+  }
+
+  //! Inserts the element.
+  void push(T const& val) {
+    const size_t index = elements.size();
+    if (OFFSET + index == priors.size()) {
+      priors.resize(priors.size() + D, sentinel());
+    }
+    elements.push_back(val);
+    sift_up(index, PriorityTraits<T>::prior(val), val);
+  }
+
+  //! Inserts the elements. A batch, which is not smaller than the heap,
+  //! is merged by rebuilding the whole heap bottom-up.
+  template<typename Iter>
+  void push(Iter b, Iter e) {
+    const size_t oldSize = elements.size();
+    elements.insert(elements.end(), b, e);
+    const size_t size = elements.size();
+    priors.resize((OFFSET + size + D - 1) / D * D, sentinel());
+    for (size_t i = oldSize; i < size; i++) {
+      priors[OFFSET + i] = PriorityTraits<T>::prior(elements[i]);
+    }
+    if (size - oldSize < oldSize) {
+      for (size_t i = oldSize; i < size; i++) {
+        const T val = elements[i];
+        sift_up(i, priors[OFFSET + i], val);
+      }
+    } else if (size > 1) {
+      for (size_t i = (size - 2) / D + 1; i-- > 0;) {
+        const T val = elements[i];
+        sift_down(i, priors[OFFSET + i], val);
+      }
+    }
+  }
+
+  //! Moves all the elements to the end of `out` in no particular order.
+  void extractAll(std::vector<T>& out) {
+    out.insert(out.end(), elements.begin(), elements.end());
+    elements.clear();
+    priors.assign(D, sentinel());
+  }
+
+  //! Deletes the minimum element and returns it. UB if the heap is empty.
+  T pop() {
+    T res = elements[0];
+    const size_t last = elements.size() - 1;
+    const Prior prior = priors[OFFSET + last];
+    T val = elements[last];
+    priors[OFFSET + last] = sentinel();
+    elements.pop_back();
+    if (last > 0) {
+      sift_down(0, prior, val);
+    }
+    return res;
+  }
+};
+
+} // namespace WorkList
+} // namespace Galois
+
+#endif // GALOIS_PACKEDHEAP_H
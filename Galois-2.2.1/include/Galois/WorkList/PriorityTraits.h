@@ -0,0 +1,63 @@
+#ifndef GALOIS_WORKLIST_PRIORITYTRAITS_H
+#define GALOIS_WORKLIST_PRIORITYTRAITS_H
+
+#include <limits>
+#include <type_traits>
+
+namespace Galois {
+namespace WorkList {
+
+/**
+ * Priority of an element for the priority worklists, which keep the
+ * priorities apart from the elements. It is `prior()` of the element by
+ * default and the element itself for arithmetic types.
+ *
+ * Specialize it for the elements without `prior()`.
+ */
+template<typename T, typename Enable = void>
+struct PriorityTraits {
+  static auto prior(T const& val) -> decltype(val.prior()) {
+    return val.prior();
+  }
+};
+
+template<typename T>
+struct PriorityTraits<T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+  static T prior(T const& val) {
+    return val;
+  }
+};
+
+/**
+ * Empty value of a priority type, it marks empty queues and slots and
+ * should not be less than the priority of any element.
+ *
+ * Defined for the types with `std::numeric_limits`, including floating
+ * point and 128-bit integers: the infinity if the type has one, the
+ * maximal value otherwise. Specialize it for other priority types.
+ *
+ * The empty value is reserved, a queue keeping only elements of that
+ * priority is taken as empty. HeapWithLock packs unsigned priorities of
+ * up to 64 bits with its lock, there every priority of 2^63 - 1 or more
+ * is reserved.
+ */
+template<typename Prior, typename Enable = void>
+struct PriorityKeyTraits;
+
+template<typename Prior>
+struct PriorityKeyTraits<Prior,
+    typename std::enable_if<std::numeric_limits<Prior>::is_specialized>::type> {
+  static Prior empty() {
+    return std::numeric_limits<Prior>::has_infinity ? std::numeric_limits<Prior>::infinity()
+                                                    : std::numeric_limits<Prior>::max();
+  }
+
+  static bool isEmpty(Prior const& p) {
+    return p == empty();
+  }
+};
+
+} // namespace WorkList
+} // namespace Galois
+
+#endif // GALOIS_WORKLIST_PRIORITYTRAITS_H
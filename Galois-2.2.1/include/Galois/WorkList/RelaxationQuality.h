@@ -0,0 +1,245 @@
+#ifndef GALOIS_WORKLIST_RELAXATIONQUALITY_H
+#define GALOIS_WORKLIST_RELAXATIONQUALITY_H
+
+#include "Galois/optional.h"
+#include "Galois/Runtime/Support.h"
+#include "Galois/Runtime/ll/SimpleLock.h"
+
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Galois {
+namespace WorkList {
+
+/**
+ * Histogram of non-negative values with power of two buckets:
+ * 0, 1, 2-3, 4-7, ...
+ */
+class Log2Histogram {
+  static const size_t BUCKETS = 32;
+  std::array<uint64_t, BUCKETS> buckets{};
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t max = 0;
+
+public:
+  void add(uint64_t value) {
+    size_t bucket = value == 0 ? 0 : 64 - __builtin_clzll(value);
+    buckets[std::min(bucket, BUCKETS - 1)]++;
+    count++;
+    sum += value;
+    max = std::max(max, value);
+  }
+
+  //! Reports the non-empty buckets, the average and the maximum
+  //! as `<name>Avg`, `<name>Max` and `<name>_<lower bound>`.
+  void report(std::string const& name) const {
+    if (count == 0) return;
+    Galois::Runtime::reportStat(nullptr, (name + "Avg").c_str(), sum / count);
+    Galois::Runtime::reportStat(nullptr, (name + "Max").c_str(), max);
+    for (size_t i = 0; i < BUCKETS; i++) {
+      if (buckets[i] == 0) continue;
+      const uint64_t lower = i == 0 ? 0 : uint64_t(1) << (i - 1);
+      Galois::Runtime::reportStat(nullptr, (name + "_" + std::to_string(lower)).c_str(), buckets[i]);
+    }
+  }
+};
+
+//! Whether the pushes to the worklist may replace the held elements or be
+//! dropped, as the worklists with `decreasesKeys` set do.
+template<typename WL, typename = void>
+struct DecreasesKeys : std::false_type {};
+
+template<typename WL>
+struct DecreasesKeys<WL, typename std::enable_if<WL::decreasesKeys>::type> : std::true_type {};
+
+/**
+ * Wraps a worklist and measures how relaxed its pops are against a shadow
+ * exact priority queue of the elements it holds.
+ *
+ * The rank error of a pop is the number of held elements, which are
+ * strictly better than the popped one; it is sampled every `SamplePeriod`
+ * pops. The delay of an element is the number of pops done while it was
+ * the best held element, it is recorded for every such element.
+ * Both are reported as histograms when the loop finishes.
+ *
+ * Every operation updates the shadow queue under a global lock, so the
+ * wrapper is meant for measurements, not for timing.
+ *
+ * The shadow queue cannot see the pushes, which a decrease-key worklist
+ * replaced or dropped, and they would stay better than the later pops.
+ * For such worklists (see DecreasesKeys) a pop of an element drops the
+ * shadow elements with the same `getID()`, which are not better than it,
+ * as their work is stale by then.
+ *
+ * @tparam WL Wrapped worklist.
+ * @tparam Comparer Elements comparator.
+ * Its `operator()` returns `true` iff the first argument should follow the second one.
+ * @tparam SamplePeriod Rank error is sampled every SamplePeriod pops.
+ */
+template<typename WL,
+         typename Comparer,
+         size_t SamplePeriod = 64>
+class RelaxationQuality {
+  typedef typename WL::value_type T;
+  //! Elements are numbered to keep duplicates apart.
+  typedef std::pair<T, uint64_t> Entry;
+
+  struct EntryLess {
+    Comparer compare;
+
+    bool operator()(Entry const& a, Entry const& b) const {
+      if (compare(b.first, a.first)) return true;
+      if (compare(a.first, b.first)) return false;
+      return a.second < b.second;
+    }
+  };
+
+  typedef __gnu_pbds::tree<Entry, __gnu_pbds::null_type, EntryLess,
+          __gnu_pbds::rb_tree_tag,
+          __gnu_pbds::tree_order_statistics_node_update> Shadow;
+
+  WL wl;
+  Comparer compare;
+  Runtime::LL::SimpleLock<true> lock;
+  Shadow shadow;
+  uint64_t pushes = 0;
+  uint64_t pops = 0;
+  //! The best element and the number of pops when it became the best.
+  uint64_t top = 0;
+  uint64_t topSince = 0;
+  Log2Histogram rankError;
+  Log2Histogram delay;
+  //! Shadow elements by their ids, kept for decrease-key worklists only.
+  std::unordered_map<uintptr_t, std::vector<Entry>> byId;
+
+  void updateTop() {
+    const uint64_t newTop = shadow.empty() ? 0 : shadow.begin()->second;
+    if (newTop != top) {
+      top = newTop;
+      topSince = pops;
+    }
+  }
+
+  void pushShadow(T const& val) {
+    shadow.insert(Entry(val, ++pushes));
+    trackId(Entry(val, pushes), DecreasesKeys<WL>());
+    updateTop();
+  }
+
+  void trackId(Entry const&, std::false_type) {}
+
+  void trackId(Entry const& entry, std::true_type) {
+    byId[entry.first.getID()].push_back(entry);
+  }
+
+  void dropStale(T const&, std::false_type) {}
+
+  //! Drops the shadow elements with the id of the popped one, which are
+  //! not better than it.
+  void dropStale(T const& val, std::true_type) {
+    auto ii = byId.find(val.getID());
+    if (ii == byId.end()) return;
+    std::vector<Entry>& entries = ii->second;
+    auto better = std::partition(entries.begin(), entries.end(),
+                                 [&](Entry const& e) { return compare(val, e.first); });
+    for (auto it = better; it != entries.end(); ++it) {
+      shadow.erase(*it);
+    }
+    entries.erase(better, entries.end());
+    if (entries.empty()) {
+      byId.erase(ii);
+    }
+  }
+
+  void popShadow(T const& val) {
+    auto it = shadow.lower_bound(Entry(val, 0));
+    while (it != shadow.end() && !compare(it->first, val) && !(it->first == val)) {
+      ++it;
+    }
+    if (it == shadow.end() || compare(it->first, val)) {
+      // Not pushed through the wrapper.
+      return;
+    }
+    if (pops % SamplePeriod == 0) {
+      rankError.add(shadow.order_of_key(Entry(val, 0)));
+    }
+    pops++;
+    if (it->second == top) {
+      delay.add(pops - topSince - 1);
+    }
+    shadow.erase(it);
+    dropStale(val, DecreasesKeys<WL>());
+    updateTop();
+  }
+
+public:
+  typedef T value_type;
+
+  //! Change the concurrency flag.
+  template<bool _concurrent>
+  struct rethread {
+    typedef RelaxationQuality<typename WL::template rethread<_concurrent>::type,
+                              Comparer, SamplePeriod> type;
+  };
+
+  //! Change the type the worklist holds.
+  template<typename _T>
+  struct retype {
+    typedef RelaxationQuality<typename WL::template retype<_T>::type,
+                              Comparer, SamplePeriod> type;
+  };
+
+  ~RelaxationQuality() {
+    rankError.report("RankError");
+    delay.report("Delay");
+  }
+
+  void push(T const& val) {
+    lock.lock();
+    pushShadow(val);
+    lock.unlock();
+    T copy = val;
+    wl.push(&copy, &copy + 1);
+  }
+
+  template<typename Iter>
+  unsigned int push(Iter b, Iter e) {
+    lock.lock();
+    for (Iter ii = b; ii != e; ++ii) {
+      pushShadow(*ii);
+    }
+    lock.unlock();
+    return wl.push(b, e);
+  }
+
+  template<typename RangeTy>
+  unsigned int push_initial(const RangeTy& range) {
+    auto rp = range.local_pair();
+    return push(rp.first, rp.second);
+  }
+
+  Galois::optional<T> pop() {
+    Galois::optional<T> val = wl.pop();
+    if (val) {
+      lock.lock();
+      popShadow(*val);
+      lock.unlock();
+    }
+    return val;
+  }
+};
+
+} // namespace WorkList
+} // namespace Galois
+
+#endif // GALOIS_WORKLIST_RELAXATIONQUALITY_H
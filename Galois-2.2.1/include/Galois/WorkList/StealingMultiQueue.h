@@ -2,192 +2,279 @@
 #define GALOIS_STEALINGMULTIQUEUE_H
 
 #include "Galois/optional.h"
+#include "Galois/Threads.h"
 #include "Galois/Runtime/ll/CacheLineStorage.h"
-
+#include "Galois/Runtime/ll/HWTopo.h"
+#include "Galois/Runtime/ll/TID.h"
+#include "Heap.h"
+#include "PackedHeap.h"
+#include "ThreadRandom.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstring>
 #include <atomic>
+#include <chrono>
 #include <cstdlib>
+#include <iterator>
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace Galois {
 namespace WorkList {
 
 /**
- * Class-helper, consists of a sequential heap and
- * a stealing buffer.
+ * Runtime parameters of the StealingMultiQueue.
  *
- * @tparam T Type of the elements.
- * @tparam Compare Elements comparator.
- * @tparam STEAL_NUM Number of elements to steal at once.
- * @tparam D Arity of the heap.
+ * They are used by the instances which have `StealProb` or `StealBatchSize`
+ * set to 0, and are read when the worklist is constructed. Thus, they
+ * should be set before the loop starts, e.g. from the command line.
  */
-template<typename T,
-         typename Compare,
-         size_t STEAL_NUM,
-         size_t D = 4>
-class HeapWithStealBuffer {
-  typedef size_t index_t;
-  // Local priority queue.
-  std::vector<T> heap;
-  // Other threads steal the whole buffer at once.
-  std::array<T, STEAL_NUM> stealBuffer;
-  // Represents epoch & stolen flag
-  // version mod 2 = 0  -- elements are stolen
-  // version mod 2 = 1  -- can steal
-  std::atomic<size_t> version;
-public:
-  // Represents a flag for empty buffer cells.
-  static T dummy;
-  // Comparator.
-  Compare compare;
+struct StealingMultiQueueParams {
+  //! Steal with 1 / stealProb probability.
+  static size_t& stealProb() {
+    static size_t value = 8;
+    return value;
+  }
 
-  HeapWithStealBuffer(): version(0) {
-    for (size_t i = 0; i < STEAL_NUM; i++) {
-      stealBuffer[i] = dummy;
-    }
+  //! Number of elements to steal at once.
+  static size_t& stealBatchSize() {
+    static size_t value = 8;
+    return value;
   }
 
-  //! Checks whether the element is "null".
-  static bool isDummy(T const& element) {
-    return element == dummy;
+  //! Maximum number of elements to claim from a buffer at once,
+  //! so that several thieves can share it. 0 means the whole buffer.
+  static size_t& stealSliceSize() {
+    static size_t value = 0;
+    return value;
   }
 
-  //! Gets current version of the stealing buffer.
-  size_t getVersion() {
-    return version.load(std::memory_order_acquire);
+  //! Probability in percents to look for a victim among SMT siblings first.
+  static size_t& stealCoreProb() {
+    static size_t value = 0;
+    return value;
   }
 
-  //! Checks whether elements in the buffer are stolen.
-  size_t isBufferStolen() {
-    return getVersion() % 2 == 0;
+  //! Probability in percents to look for a victim in the same package first.
+  //! If both probabilities are 0, victims are selected uniformly.
+  static size_t& stealPackageProb() {
+    static size_t value = 0;
+    return value;
   }
+};
 
-  //! Fills stealing buffer if the current tasks are stolen.
-  void fillBufferIfStolen() {
-    if (isBufferStolen()) {
-      fillBuffer();
+/**
+ * Selects steal victims level by level: SMT siblings of the thread,
+ * then threads of the same package, then threads of other packages.
+ * The starting level is chosen with the given probabilities, empty levels
+ * are skipped outwards. Uses the HW topology, so it is built only for
+ * threads known to it.
+ */
+class StealVictims {
+  enum { CORE, PACKAGE, REMOTE, LEVELS };
+  //! Threads sorted by package and core.
+  std::vector<size_t> order;
+  //! Position of the thread in `order`.
+  std::vector<size_t> position;
+  //! Range of the core and the package of the thread in `order`.
+  std::vector<std::array<size_t, 4>> ranges;
+  size_t coreProb;
+  size_t packageProb;
+
+  //! Number of victims of the thread on the level.
+  size_t levelSize(size_t tId, size_t level) const {
+    auto const& r = ranges[tId];
+    switch (level) {
+      case CORE: return r[1] - r[0] - 1;
+      case PACKAGE: return (r[3] - r[2]) - (r[1] - r[0]);
+      default: return order.size() - (r[3] - r[2]);
     }
   }
 
-  //! Get min among elements that can be stolen.
-  //! Sets a flag to true, if operation failed because of a race.
-  T getBufferMin(bool& raceHappened) {
-    auto v1 = getVersion();
-    if (v1 % 2 == 0) {
-      return dummy;
-    }
-    T minVal = stealBuffer[0];
-    auto v2 = getVersion();
-    if (v1 == v2) {
-      return minVal;
+  //! The k-th victim of the thread on the level.
+  size_t victim(size_t tId, size_t level, size_t k) const {
+    auto const& r = ranges[tId];
+    switch (level) {
+      case CORE: return order[r[0] + k < position[tId] ? r[0] + k : r[0] + k + 1];
+      case PACKAGE: return order[r[2] + k < r[0] ? r[2] + k : r[2] + k + (r[1] - r[0])];
+      default: return order[k < r[2] ? k : k + (r[3] - r[2])];
     }
-    // Somebody has stolen the elements.
-    raceHappened = true;
-    return dummy;
   }
 
-  //! Returns min element from the buffer, updating the buffer if empty.
-  //! Can be called only by the thread-owner.
-  T getMinWriter() {
-    auto v1 = getVersion();
-    if (v1 % 2 != 0) {
-      T minVal = stealBuffer[0];
-      auto v2 = getVersion();
-      if (v1 == v2) {
-        return minVal;
+public:
+  StealVictims(size_t nT, size_t coreProb, size_t packageProb) :
+      order(nT), position(nT), ranges(nT),
+      coreProb(coreProb), packageProb(packageProb) {
+    using namespace Galois::Runtime::LL;
+    for (size_t i = 0; i < nT; i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [](size_t a, size_t b) {
+      return std::make_pair(getPackageForThread(a), getCoreForThread(a))
+           < std::make_pair(getPackageForThread(b), getCoreForThread(b));
+    });
+    for (size_t i = 0; i < nT; i++) position[order[i]] = i;
+    for (size_t i = 0; i < nT;) {
+      size_t packageEnd = i;
+      while (packageEnd < nT &&
+             getPackageForThread(order[packageEnd]) == getPackageForThread(order[i]))
+        packageEnd++;
+      for (size_t j = i; j < packageEnd;) {
+        size_t coreEnd = j;
+        while (coreEnd < packageEnd &&
+               getCoreForThread(order[coreEnd]) == getCoreForThread(order[j]))
+          coreEnd++;
+        for (size_t k = j; k < coreEnd; k++)
+          ranges[order[k]] = {{ j, coreEnd, i, packageEnd }};
+        j = coreEnd;
       }
+      i = packageEnd;
     }
-    return fillBuffer();
   }
 
-  //! Fills the steal buffer.
-  //! Called when the elements from the previous epoch are empty.
-  T fillBuffer() {
-    if (heap.empty()) return dummy;
-    std::array<T, STEAL_NUM> elements;
-    elements.fill(dummy);
-    for (size_t i = 0; i < STEAL_NUM && !heap.empty(); i++) {
-      elements[i] = popLocally();
-    }
-    stealBuffer = elements;
-    version.fetch_add(1, std::memory_order_acq_rel);
-    return elements[0];
+  //! Whether the victims can be selected for that many threads.
+  static bool isSupported(size_t nT) {
+    return nT <= Galois::Runtime::LL::getMaxThreads();
   }
 
-  //! Tries to steal the elements from the stealing buffer.
-  Galois::optional<std::array<T, STEAL_NUM>> trySteal(bool& raceHappened) {
-    auto emptyRes = Galois::optional<std::array<T, STEAL_NUM>>();
-    auto v1 = getVersion();
-    if (v1 % 2 == 0) {
-      // Already stolen.
-      return emptyRes;
+  //! Random victim for the thread, which should not be the only one.
+  size_t select(size_t tId, uint32_t random) const {
+    const size_t r = random % 100;
+    const size_t start = r < coreProb ? CORE : r < coreProb + packageProb ? PACKAGE : REMOTE;
+    // Empty levels are skipped outwards, then inwards.
+    for (size_t i = 0; i < LEVELS; i++) {
+      const size_t level = start + i < LEVELS ? start + i : LEVELS - 1 - i;
+      const size_t size = levelSize(tId, level);
+      if (size > 0)
+        return victim(tId, level, random / 100 % size);
     }
-    std::array<T, STEAL_NUM> buffer = stealBuffer;
-    if (version.compare_exchange_weak(v1, v1 + 1, std::memory_order_acq_rel)) {
-      return buffer;
-    }
-    // Another thread got ahead.
-    raceHappened = true;
-    return emptyRes;
+    return tId;
   }
+};
 
-  //! Retrieves an element from the heap.
-  T popLocally() {
-    auto res = heap[0];
-    heap[0] = heap.back();
-    heap.pop_back();
-    if (heap.size() > 0) {
-      sift_down(0);
-    }
-    return res;
+/**
+ * Storage for the elements of a stealing buffer.
+ *
+ * @tparam T Type of the elements.
+ * @tparam N Capacity of the buffer. 0 means it is set at runtime.
+ */
+template<typename T, size_t N>
+struct StealBufferStorage {
+  std::array<T, N> elements;
+
+  void resize(size_t) {}
+
+  size_t size() const {
+    return N;
   }
 
-  //! Extract min from the structure: both the buffer and the heap
-  //! are considered. Called from the owner-thread.
-  Galois::optional<T> extractMin() {
-    if (heap.empty()) {
-      // Only check the steal buffer.
-      return tryStealLocally();
-    }
-    bool raceFlag = false;  // useless now
-    auto bufferMin = getBufferMin(raceFlag);
-    if (!isDummy(bufferMin) && compare(heap[0], bufferMin)) {
-      auto stolen = tryStealLocally();
-      if (stolen.is_initialized()) {
-        fillBuffer();
-        return stolen;
-      }
-    }
-    auto localMin = popLocally();
-    if (isDummy(bufferMin)) fillBuffer();
-    return localMin;
+  T& operator[](size_t i) {
+    return elements[i];
   }
+};
 
-  //! Inserts the element into the heap.
-  void pushLocally(T const& val) {
+template<typename T>
+struct StealBufferStorage<T, 0> {
+  std::vector<T> elements;
+
+  void resize(size_t size) {
+    elements.resize(size);
+  }
+
+  size_t size() const {
+    return elements.size();
+  }
+
+  T& operator[](size_t i) {
+    return elements[i];
+  }
+};
+
+/**
+ * Elements stolen from another thread, which are not processed yet.
+ * They are stored in increasing order.
+ */
+template<typename T>
+struct StolenElements {
+  std::vector<T> elements;
+  size_t next = 0;
+  size_t size = 0;
+
+  bool empty() const {
+    return next == size;
+  }
+
+  T pop() {
+    return elements[next++];
+  }
+};
+
+/**
+ * Sequential d-ary heap of the elements.
+ *
+ * @tparam T Type of the elements.
+ * @tparam Compare Elements comparator.
+ * @tparam D Arity of the heap.
+ */
+template<typename T,
+         typename Compare,
+         size_t D>
+class SequentialHeap {
+  typedef size_t index_t;
+  std::vector<T> heap;
+  Compare compare;
+
+public:
+  bool empty() const {
+    return heap.empty();
+  }
+
+  size_t size() const {
+    return heap.size();
+  }
+
+  //! Minimum element in the heap. UB if the heap is empty.
+  T const& top() const {
+    return heap[0];
+  }
+
+  //! Inserts the element.
+  void push(T const& val) {
     index_t index = heap.size();
     heap.push_back({val});
     sift_up(index);
   }
 
-private:
-  //! Tries to steal elements from local buffer.
-  //! Return minimum among stolen elements.
-  Galois::optional<T> tryStealLocally() {
-    bool raceFlag = false;  // useless now
-    auto stolen = trySteal(raceFlag);
-    if (stolen.is_initialized()) {
-      auto elements = stolen.get();
-      for (size_t i = 1; i < STEAL_NUM && !isDummy(elements[i]); i++) {
-        pushLocally(elements[i]);
+  //! Inserts the elements. A batch, which is not smaller than the heap,
+  //! is merged by rebuilding the whole heap bottom-up.
+  template<typename Iter>
+  void push(Iter b, Iter e) {
+    const size_t oldSize = heap.size();
+    heap.insert(heap.end(), b, e);
+    if (heap.size() - oldSize < oldSize) {
+      for (index_t i = oldSize; i < heap.size(); i++) {
+        sift_up(i);
+      }
+    } else if (heap.size() > 1) {
+      for (index_t i = (heap.size() - 2) / D + 1; i-- > 0;) {
+        sift_down(i);
       }
-      return elements[0];
     }
-    return Galois::optional<T>();
   }
 
-  ///////////////////////// HEAP /////////////////////////
+  //! Deletes the minimum element and returns it. UB if the heap is empty.
+  T pop() {
+    auto res = heap[0];
+    heap[0] = heap.back();
+    heap.pop_back();
+    if (heap.size() > 0) {
+      sift_down(0);
+    }
+    return res;
+  }
+
+private:
   void swap(index_t  i, index_t j) {
     T t = heap[i];
     heap[i] = heap[j];
@@ -251,67 +338,422 @@ private:
   }
 };
 
+/**
+ * Sequential heap, which keeps the positions of the elements in the indexer,
+ * see DecreaseKeyIndexer. Pushing an element which is already in the heap
+ * decreases its key instead, or drops it if the key in the heap is smaller.
+ * Elements tracked by another heap are inserted.
+ *
+ * @tparam T Type of the elements.
+ * @tparam Compare Elements comparator.
+ * @tparam D Arity of the heap.
+ * @tparam Indexer Stores the heap and the position of an element.
+ */
+template<typename T,
+         typename Compare,
+         size_t D,
+         typename Indexer>
+class DecreaseKeyHeap {
+  DAryHeap<T, Compare, D> heap;
+  Indexer indexer;
+
+public:
+  //! Sets the index of the heap, which is stored in the indexer.
+  void set_index(size_t index) {
+    heap.set_index(index);
+  }
+
+  bool empty() {
+    return heap.empty();
+  }
+
+  size_t size() {
+    return heap.size();
+  }
+
+  //! Minimum element in the heap. UB if the heap is empty.
+  T top() {
+    return heap.min();
+  }
+
+  //! Inserts the element or decreases its key.
+  void push(T const& val) {
+    heap.decrease_key(indexer, val);
+  }
+
+  template<typename Iter>
+  void push(Iter b, Iter e) {
+    while (b != e) {
+      push(*b++);
+    }
+  }
+
+  //! Deletes the minimum element and returns it. UB if the heap is empty.
+  T pop() {
+    return heap.extractMin(indexer);
+  }
+};
+
+//! Local heap of HeapWithStealBuffer: packed if the priority type is set,
+//! with decrease-key if the indexer is set.
+template<typename T, typename Compare, size_t D, typename Prior, typename Indexer>
+struct LocalHeapOf {
+  static_assert(std::is_void<Prior>::value, "Packed heap does not support decrease-key");
+  typedef DecreaseKeyHeap<T, Compare, D, Indexer> type;
+};
+
+template<typename T, typename Compare, size_t D, typename Prior>
+struct LocalHeapOf<T, Compare, D, Prior, void> {
+  typedef PackedDAryHeap<T, Prior, D> type;
+};
+
+template<typename T, typename Compare, size_t D>
+struct LocalHeapOf<T, Compare, D, void, void> {
+  typedef SequentialHeap<T, Compare, D> type;
+};
+
+/**
+ * Class-helper, consists of a sequential heap and
+ * a stealing buffer.
+ *
+ * @tparam T Type of the elements.
+ * @tparam Compare Elements comparator.
+ * @tparam STEAL_NUM Number of elements to steal at once.
+ * 0 means it is set at runtime with `setStealNum`.
+ * @tparam D Arity of the heap.
+ * @tparam Prior Type of T's priority. If set, the heap keeps the priorities
+ * apart from the elements, see PackedDAryHeap. Elements are then ordered by PriorityTraits, which should
+ * agree with `Compare`.
+ * @tparam Indexer If set, pushing an element, which is in the heap already,
+ * decreases its key, see DecreaseKeyHeap.
+ */
 template<typename T,
          typename Compare,
          size_t STEAL_NUM,
-         size_t D>
-T HeapWithStealBuffer<T, Compare, STEAL_NUM, D>::dummy;
+         size_t D = 4,
+         typename Prior = void,
+         typename Indexer = void>
+class HeapWithStealBuffer {
+  // Local priority queue.
+  typename LocalHeapOf<T, Compare, D, Prior, Indexer>::type heap;
+  // Other threads claim slices of the buffer.
+  StealBufferStorage<T, STEAL_NUM> stealBuffer;
+  // Elements of the batch being pushed.
+  std::vector<T> batch;
+  // Epoch, number of elements and number of claimed elements of the buffer:
+  // | epoch: 32 bits | count: 16 bits | claimed: 16 bits |
+  // The buffer is refilled only when all the elements are claimed,
+  // thieves copy their slice first and then claim it with a CAS,
+  // which fails if the buffer was changed in between.
+  std::atomic<uint64_t> state;
+
+  static const uint64_t COUNT_MASK = 0xffff;
+
+  static size_t getCount(uint64_t st) {
+    return (st >> 16) & COUNT_MASK;
+  }
+
+  static size_t getClaimed(uint64_t st) {
+    return st & COUNT_MASK;
+  }
+
+  static_assert(STEAL_NUM <= COUNT_MASK, "Steal buffer is too large");
+
+public:
+  // Comparator.
+  Compare compare;
+
+  HeapWithStealBuffer(): state(0) {}
+
+  //! Sets the number of elements to steal at once.
+  //! Used only if STEAL_NUM is 0, should be called before the buffer is used.
+  void setStealNum(size_t stealNum) {
+    stealBuffer.resize(std::min<size_t>(stealNum, COUNT_MASK));
+  }
+
+  //! Sets the index of the heap among the heaps of the worklist.
+  void setIndex(size_t index) {
+    setIndex(index, std::is_void<Indexer>());
+  }
+
+  //! Number of elements to steal at once.
+  size_t getStealNum() const {
+    return STEAL_NUM != 0 ? STEAL_NUM : stealBuffer.size();
+  }
+
+  //! Gets current state of the stealing buffer.
+  uint64_t getState() {
+    return state.load(std::memory_order_acquire);
+  }
+
+  //! Checks whether all the elements in the buffer are claimed.
+  bool isBufferStolen() {
+    auto st = getState();
+    return getClaimed(st) == getCount(st);
+  }
+
+  //! Fills stealing buffer if the current tasks are stolen.
+  void fillBufferIfStolen() {
+    if (isBufferStolen()) {
+      fillBuffer();
+    }
+  }
+
+  //! Get min among elements that can be stolen, empty if there are none.
+  //! Sets a flag to true, if operation failed because of a race.
+  Galois::optional<T> getBufferMin(bool& raceHappened) {
+    auto st1 = getState();
+    if (getClaimed(st1) == getCount(st1)) {
+      return Galois::optional<T>();
+    }
+    T minVal = stealBuffer[getClaimed(st1)];
+    auto st2 = getState();
+    if (st1 == st2) {
+      return minVal;
+    }
+    // Somebody has stolen the elements.
+    raceHappened = true;
+    return Galois::optional<T>();
+  }
 
+  //! Returns min element from the buffer, updating the buffer if empty.
+  //! Can be called only by the thread-owner.
+  Galois::optional<T> getMinWriter() {
+    auto st1 = getState();
+    // Thieves may claim a part of the buffer meanwhile, it is refilled
+    // only when all of it is claimed.
+    while (getClaimed(st1) != getCount(st1)) {
+      T minVal = stealBuffer[getClaimed(st1)];
+      auto st2 = getState();
+      if (st1 == st2) {
+        return minVal;
+      }
+      st1 = st2;
+    }
+    return fillBuffer();
+  }
+
+  //! Fills the steal buffer, returns its minimum.
+  //! Called when the elements from the previous epoch are claimed.
+  Galois::optional<T> fillBuffer() {
+    if (heap.empty()) return Galois::optional<T>();
+    const size_t stealNum = getStealNum();
+    size_t count = 0;
+    for (; count < stealNum && !heap.empty(); count++) {
+      stealBuffer[count] = popLocally();
+    }
+    publishBuffer(count);
+    return stealBuffer[0];
+  }
+
+  //! Tries to steal at most `maxNum` elements from the stealing buffer.
+  //! Returns the number of stolen elements, which are written to `buffer`.
+  size_t trySteal(bool& raceHappened, T* buffer, size_t maxNum) {
+    auto st = getState();
+    const size_t claimed = getClaimed(st);
+    const size_t stolen = std::min(getCount(st) - claimed, maxNum);
+    if (stolen == 0) {
+      // Already stolen.
+      return 0;
+    }
+    for (size_t i = 0; i < stolen; i++) {
+      buffer[i] = stealBuffer[claimed + i];
+    }
+    if (state.compare_exchange_weak(st, st + stolen, std::memory_order_acq_rel)) {
+      return stolen;
+    }
+    // Another thread got ahead.
+    raceHappened = true;
+    return 0;
+  }
+
+  //! Retrieves an element from the heap.
+  T popLocally() {
+    return heap.pop();
+  }
+
+  //! Extract min from the structure: both the buffer and the heap
+  //! are considered. Called from the owner-thread.
+  Galois::optional<T> extractMin() {
+    if (heap.empty()) {
+      // Only check the steal buffer.
+      return tryStealLocally();
+    }
+    bool raceFlag = false;
+    auto bufferMin = getBufferMin(raceFlag);
+    if (bufferMin && compare(heap.top(), *bufferMin)) {
+      auto stolen = tryStealLocally();
+      if (stolen.is_initialized()) {
+        fillBuffer();
+        return stolen;
+      }
+    }
+    auto localMin = popLocally();
+    // The buffer may be claimed only partially, if the read raced.
+    if (!bufferMin) fillBufferIfStolen();
+    return localMin;
+  }
+
+  //! Inserts the element into the heap.
+  void pushLocally(T const& val) {
+    heap.push(val);
+  }
+
+  //! Inserts the elements into the heap at once. If the buffer is stolen,
+  //! it is refilled with the best elements of the batch and the heap,
+  //! so that they are not pushed into the heap only to be popped again.
+  template<typename Iter>
+  void pushBatch(Iter b, Iter e) {
+    if (!isBufferStolen()) {
+      heap.push(b, e);
+      return;
+    }
+    batch.assign(b, e);
+    const size_t stealNum = getStealNum();
+    const size_t best = std::min(stealNum, batch.size());
+    std::partial_sort(batch.begin(), batch.begin() + best, batch.end(),
+                      [this](T const& a, T const& b) { return compare(b, a); });
+    size_t used = 0;
+    size_t count = 0;
+    for (; count < stealNum; count++) {
+      if (used < best && (heap.empty() || !compare(batch[used], heap.top()))) {
+        stealBuffer[count] = batch[used++];
+      } else if (!heap.empty()) {
+        stealBuffer[count] = popLocally();
+      } else {
+        break;
+      }
+    }
+    if (count > 0) {
+      publishBuffer(count);
+    }
+    heap.push(batch.begin() + used, batch.end());
+  }
+
+private:
+  void setIndex(size_t, std::true_type) {}
+
+  void setIndex(size_t index, std::false_type) {
+    heap.set_index(index);
+  }
+
+  //! Publishes the first `count` elements of the buffer in a new epoch.
+  void publishBuffer(size_t count) {
+    const uint64_t epoch = (getState() >> 32) + 1;
+    state.store((epoch << 32) | (count << 16), std::memory_order_release);
+  }
+
+  //! Tries to claim the rest of the local buffer.
+  //! Return minimum among stolen elements.
+  Galois::optional<T> tryStealLocally() {
+    auto st = getState();
+    while (getClaimed(st) != getCount(st)) {
+      const size_t claimed = getClaimed(st);
+      const size_t count = getCount(st);
+      if (state.compare_exchange_weak(st, st + (count - claimed),
+                                      std::memory_order_acq_rel)) {
+        // Only the owner writes the buffer, so the elements
+        // can be read after they are claimed.
+        for (size_t i = claimed + 1; i < count; i++) {
+          pushLocally(stealBuffer[i]);
+        }
+        return stealBuffer[claimed];
+      }
+    }
+    return Galois::optional<T>();
+  }
+};
+
+/**
+ * StealingMultiQueue: each thread owns a sequential heap, the best
+ * elements of which are exposed to other threads via a stealing buffer.
+ *
+ * @tparam T Type of the elements.
+ * @tparam Comparer Elements comparator.
+ * @tparam StealProb Steal with 1 / StealProb probability.
+ * 0 means the value is taken from StealingMultiQueueParams.
+ * @tparam StealBatchSize Number of elements to steal at once.
+ * 0 means the value is taken from StealingMultiQueueParams.
+ * @tparam Concurrent if the implementation should be concurrent
+ * @tparam Prior Type of T's priority. If set, the local heaps use
+ * the packed layout, see HeapWithStealBuffer.
+ * @tparam D Arity of the local heaps.
+ * @tparam DecreaseKeyIndexer If set, an element pushed to the heap of
+ * the thread, which holds it already, decreases its key instead of being
+ * inserted once more, see DecreaseKeyHeap.
+ */
 template<typename T,
          typename Comparer,
          size_t StealProb,
          size_t StealBatchSize,
-         bool Concurrent = true
+         bool Concurrent = true,
+         typename Prior = void,
+         size_t D = 4,
+         typename DecreaseKeyIndexer = void
 >
 class StealingMultiQueue {
 private:
-  typedef HeapWithStealBuffer<T, Comparer, StealBatchSize, 4> Heap;
+  typedef HeapWithStealBuffer<T, Comparer, StealBatchSize, D, Prior, DecreaseKeyIndexer> Heap;
   std::unique_ptr<Galois::Runtime::LL::CacheLineStorage<Heap>[]> heaps;
-  std::unique_ptr<Galois::Runtime::LL::CacheLineStorage<std::vector<T>>[]> stealBuffers;
+  std::unique_ptr<Galois::Runtime::LL::CacheLineStorage<StolenElements<T>>[]> stealBuffers;
   Comparer compare;
   const size_t nQ;
+  //! Steal probability, used if StealProb is 0.
+  size_t stealProb;
+  //! stealProb - 1 if stealProb is a power of two, 0 otherwise.
+  size_t stealMask;
+  //! Maximum number of elements to steal from a buffer at once.
+  size_t stealSlice;
+  //! Locality-aware victim selection, uniform if null.
+  std::unique_ptr<StealVictims> victims;
+  ThreadRandom rng;
 
   //! Thread local random.
   uint32_t random() {
-    static thread_local uint32_t x =
-        std::chrono::system_clock::now().time_since_epoch().count() % 16386 + 1;
-    x ^= x << 13;
-    x ^= x >> 17;
-    x ^= x << 5;
-    return x;
+    return rng();
   }
 
-  //! Index of a random heap.
-  size_t rand_heap() {
+  //! Index of a random heap to steal from.
+  size_t rand_heap(size_t tId) {
+    if (victims) {
+      return victims->select(tId, random());
+    }
     return random() % nQ;
   }
 
+  //! Checks whether we should try stealing before popping locally.
+  bool shouldSteal() {
+    if (StealProb != 0) {
+      return random() % StealProb == 0;
+    }
+    if (stealMask != 0 || stealProb == 1) {
+      return (random() & stealMask) == 0;
+    }
+    return random() % stealProb == 0;
+  }
+
   //! Tries to steal from a random queue.
   //! Repeats if failed because of a race.
-  Galois::optional<T> trySteal(int tId) {
-    T localMin = heaps[tId].data.getMinWriter();
+  Galois::optional<T> trySteal(size_t tId) {
+    Galois::optional<T> localMin = heaps[tId].data.getMinWriter();
     bool nextIterNeeded = true;
     while (nextIterNeeded) {
-      auto randId = rand_heap();
+      auto randId = rand_heap(tId);
       if (randId == tId) continue;
       nextIterNeeded = false;
       Heap *randH = &heaps[randId].data;
       auto randMin = randH->getBufferMin(nextIterNeeded);
-      if (randH->isDummy(randMin)) {
+      if (!randMin) {
         // Nothing to steal.
         continue;
       }
-      if (Heap::isDummy(localMin) || compare(localMin, randMin)) {
-        auto stolen = randH->trySteal(nextIterNeeded);
-        if (stolen.is_initialized()) {
-          auto &buffer = stealBuffers[tId].data;
-          auto elements = stolen.get();
-          for (size_t i = 1; i < elements.size() &&
-                                 !Heap::isDummy(elements[i]); i++) {
-            buffer.push_back(elements[i]);
-          }
-          std::reverse(buffer.begin(), buffer.end());
-          return elements[0];
+      if (!localMin || compare(*localMin, *randMin)) {
+        auto& buffer = stealBuffers[tId].data;
+        auto stolen = randH->trySteal(nextIterNeeded, buffer.elements.data(), stealSlice);
+        if (stolen > 0) {
+          buffer.next = 1;
+          buffer.size = stolen;
+          return buffer.elements[0];
         }
       }
     }
@@ -319,25 +761,46 @@ private:
   }
 
 public:
+  StealingMultiQueue() : StealingMultiQueue(Galois::getActiveThreads()) {}
+
   StealingMultiQueue(int num_threads) : nQ(num_threads) {
-    std::memset(reinterpret_cast<void*>(&Heap::dummy), 0xff, sizeof(Heap::dummy));
+    stealProb = StealProb != 0 ? StealProb
+                               : std::max<size_t>(1, StealingMultiQueueParams::stealProb());
+    stealMask = (stealProb & (stealProb - 1)) == 0 ? stealProb - 1 : 0;
+    const size_t stealNum = StealBatchSize != 0 ? StealBatchSize
+                            : std::max<size_t>(1, StealingMultiQueueParams::stealBatchSize());
+    const size_t sliceSize = StealingMultiQueueParams::stealSliceSize();
+    stealSlice = sliceSize != 0 ? std::min(sliceSize, stealNum) : stealNum;
     heaps = std::make_unique<Galois::Runtime::LL::CacheLineStorage<Heap>[]>(nQ);
     stealBuffers = std::make_unique<
-                   Galois::Runtime::LL::CacheLineStorage<std::vector<T>>[]>(nQ);
+                   Galois::Runtime::LL::CacheLineStorage<StolenElements<T>>[]>(nQ);
+    for (size_t i = 0; i < nQ; i++) {
+      heaps[i].data.setStealNum(stealNum);
+      heaps[i].data.setIndex(i);
+      stealBuffers[i].data.elements.resize(stealNum);
+    }
+    const size_t coreProb = StealingMultiQueueParams::stealCoreProb();
+    const size_t packageProb = StealingMultiQueueParams::stealPackageProb();
+    if ((coreProb != 0 || packageProb != 0) && StealVictims::isSupported(nQ)) {
+      victims = std::make_unique<StealVictims>(nQ, coreProb, packageProb);
+    }
   }
 
   typedef T value_type;
 
+  //! Pushes may replace the held elements or be dropped, see DecreaseKeyHeap.
+  static const bool decreasesKeys = !std::is_void<DecreaseKeyIndexer>::value;
+
   //! Change the concurrency flag.
   template<bool _concurrent>
   struct rethread {
-    typedef StealingMultiQueue<T, Comparer, StealProb, StealBatchSize, _concurrent> type;
+    typedef StealingMultiQueue<T, Comparer, StealProb, StealBatchSize, _concurrent, Prior, D, DecreaseKeyIndexer> type;
   };
 
   //! Change the type the worklist holds.
   template<typename _T>
   struct retype {
-    typedef StealingMultiQueue<_T, Comparer, StealProb, StealBatchSize, Concurrent> type;
+    typedef StealingMultiQueue<_T, Comparer, StealProb, StealBatchSize, Concurrent, Prior, D, DecreaseKeyIndexer> type;
   };
 
   template<typename RangeTy>
@@ -347,30 +810,33 @@ public:
   }
 
   template<typename Iter>
-  unsigned int push(int tId, Iter b, Iter e) {
+  unsigned int push(Iter b, Iter e) {
+    return push(Galois::Runtime::LL::getTID(), b, e);
+  }
+
+  template<typename Iter>
+  unsigned int push(size_t tId, Iter b, Iter e) {
     if (b == e) return 0;
-    unsigned int pushedNum = 0;
-    Heap* heap = &heaps[tId].data;
-    while (b != e) {
-      heap->pushLocally(*b++);
-      pushedNum++;
-    }
-    heap->fillBufferIfStolen();
+    const unsigned int pushedNum = std::distance(b, e);
+    heaps[tId].data.pushBatch(b, e);
     return pushedNum;
   }
 
-  Galois::optional<T> pop(int tId) {
+  Galois::optional<T> pop() {
+    return pop(Galois::Runtime::LL::getTID());
+  }
+
+  Galois::optional<T> pop(size_t tId) {
     auto& buffer = stealBuffers[tId].data;
     if (!buffer.empty()) {
-      auto val = buffer.back();
-      buffer.pop_back();
+      auto val = buffer.pop();
       heaps[tId].data.fillBufferIfStolen();
       return val;
     }
     Galois::optional<T> emptyResult;
     // rand == 0 -- try to steal
     // otherwise, pop locally
-    if (nQ > 1 && random() % StealProb == 0) {
+    if (nQ > 1 && shouldSteal()) {
       Galois::optional<T> stolen = trySteal(tId);
       if (stolen.is_initialized()) return stolen;
     }
@@ -382,6 +848,42 @@ public:
   }
 };
 
+template<typename T, typename Comparer, size_t StealProb, size_t StealBatchSize,
+         bool Concurrent, typename Prior, size_t D, typename DecreaseKeyIndexer>
+const bool StealingMultiQueue<T, Comparer, StealProb, StealBatchSize, Concurrent,
+                              Prior, D, DecreaseKeyIndexer>::decreasesKeys;
+
+/**
+ * StealingMultiQueue which takes the steal probability and the number
+ * of elements to steal at once from StealingMultiQueueParams, so that
+ * they can be tuned without recompilation.
+ */
+template<typename T,
+         typename Comparer,
+         bool Concurrent = true>
+using RuntimeStealingMultiQueue = StealingMultiQueue<T, Comparer, 0, 0, Concurrent>;
+
+/**
+ * RuntimeStealingMultiQueue with the packed local heaps, which keep
+ * the priorities of type `Prior` apart from the elements.
+ */
+template<typename T,
+         typename Comparer,
+         typename Prior = unsigned long,
+         size_t D = PACKED_HEAP_LINE / sizeof(Prior),
+         bool Concurrent = true>
+using PackedStealingMultiQueue = StealingMultiQueue<T, Comparer, 0, 0, Concurrent, Prior, D>;
+
+/**
+ * RuntimeStealingMultiQueue with decrease-key in the local heaps,
+ * `Indexer` stores the heap and the position of every element.
+ */
+template<typename T,
+         typename Comparer,
+         typename Indexer,
+         bool Concurrent = true>
+using DecreaseKeyStealingMultiQueue =
+    StealingMultiQueue<T, Comparer, 0, 0, Concurrent, void, 4, Indexer>;
 
 }  // namespace WorkList
 }  // namespace Galois
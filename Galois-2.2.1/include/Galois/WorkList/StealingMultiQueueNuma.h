@@ -3,16 +3,28 @@
 
 #include <atomic>
 #include <cstdlib>
+#include <iterator>
 #include <memory>
 #include <vector>
 
 #include "StealingMultiQueue.h"
+#include "MQOptimized/NumaQueueMap.h"
 
 
 namespace Galois {
 namespace WorkList {
 
-
+/**
+ * StealingMultiQueue, which steals from the queues of the local
+ * NUMA node more often.
+ *
+ * @tparam StealProb Steal with 1 / StealProb probability.
+ * 0 means the value is taken from StealingMultiQueueParams.
+ * @tparam StealBatchSize Number of elements to steal at once.
+ * 0 means the value is taken from StealingMultiQueueParams.
+ * @tparam LOCAL_NUMA_W Weight of a queue on the local NUMA node.
+ * 0 means the value is taken from NumaParams.
+ */
 template<typename T,
 typename Comparer,
 size_t StealProb,
@@ -24,18 +36,16 @@ class StealingMultiQueueNuma {
 private:
   typedef HeapWithStealBuffer<T, Comparer, StealBatchSize, 4> Heap;
   std::unique_ptr<Galois::Runtime::LL::CacheLineStorage<Heap>[]> heaps;
-  std::unique_ptr<Galois::Runtime::LL::CacheLineStorage<std::vector<T>>[]> stealBuffers;
+  std::unique_ptr<Galois::Runtime::LL::CacheLineStorage<StolenElements<T>>[]> stealBuffers;
   Comparer compare;
   const size_t nQ;
+  //! Steal probability, StealProb or the runtime parameter if it is 0.
+  size_t stealProb;
+  ThreadRandom rng;
 
   //! Thread local random.
   uint32_t random() {
-    static thread_local uint32_t x =
-        std::chrono::system_clock::now().time_since_epoch().count() % 16386 + 1;
-    x ^= x << 13;
-    x ^= x >> 17;
-    x ^= x << 5;
-    return x;
+    return rng();
   }
   
   const size_t C = 1;
@@ -45,8 +55,8 @@ private:
   //! Tries to steal from a random queue.
   //! Repeats if failed because of a race.
   Galois::optional<T> trySteal() {
-    static thread_local size_t tId = Galois::Runtime::LL::getTID();
-    T localMin = heaps[tId].data.getMinWriter();
+    const size_t tId = Galois::Runtime::LL::getTID();
+    Galois::optional<T> localMin = heaps[tId].data.getMinWriter();
     bool nextIterNeeded = true;
     while (nextIterNeeded) {
       auto randId = rand_heap();
@@ -54,21 +64,18 @@ private:
       nextIterNeeded = false;
       Heap *randH = &heaps[randId].data;
       auto randMin = randH->getBufferMin(nextIterNeeded);
-      if (randH->isDummy(randMin)) {
+      if (!randMin) {
         // Nothing to steal.
         continue;
       }
-      if (Heap::isDummy(localMin) || compare(localMin, randMin)) {
-        auto stolen = randH->trySteal(nextIterNeeded);
-        if (stolen.is_initialized()) {
-          auto &buffer = stealBuffers[tId].data;
-          auto elements = stolen.get();
-          for (size_t i = 1; i < elements.size() &&
-                             !Heap::isDummy(elements[i]); i++) {
-            buffer.push_back(elements[i]);
-          }
-          std::reverse(buffer.begin(), buffer.end());
-          return elements[0];
+      if (!localMin || compare(*localMin, *randMin)) {
+        auto& buffer = stealBuffers[tId].data;
+        auto stolen = randH->trySteal(nextIterNeeded, buffer.elements.data(),
+                                      buffer.elements.size());
+        if (stolen > 0) {
+          buffer.next = 1;
+          buffer.size = stolen;
+          return buffer.elements[0];
         }
       }
     }
@@ -77,9 +84,16 @@ private:
 
 public:
   StealingMultiQueueNuma() : nQ(Galois::getActiveThreads()) {
-    memset(reinterpret_cast<void*>(&Heap::dummy), 0xff, sizeof(Heap::dummy));
+    stealProb = StealProb != 0 ? StealProb
+                               : std::max<size_t>(1, StealingMultiQueueParams::stealProb());
+    const size_t stealNum = StealBatchSize != 0 ? StealBatchSize
+                            : std::max<size_t>(1, StealingMultiQueueParams::stealBatchSize());
     heaps = std::make_unique<Galois::Runtime::LL::CacheLineStorage<Heap>[]>(nQ);
-    stealBuffers = std::make_unique<Galois::Runtime::LL::CacheLineStorage<std::vector<T>>[]>(nQ);
+    stealBuffers = std::make_unique<Galois::Runtime::LL::CacheLineStorage<StolenElements<T>>[]>(nQ);
+    for (size_t i = 0; i < nQ; i++) {
+      heaps[i].data.setStealNum(stealNum);
+      stealBuffers[i].data.elements.resize(stealNum);
+    }
   }
 
   typedef T value_type;
@@ -109,31 +123,25 @@ public:
 
   template<typename Iter>
   unsigned int push(Iter b, Iter e) {
-    static thread_local size_t tId = Galois::Runtime::LL::getTID();
+    const size_t tId = Galois::Runtime::LL::getTID();
     if (b == e) return 0;
-    unsigned int pushedNum = 0;
-    Heap* heap = &heaps[tId].data;
-    while (b != e) {
-      heap->pushLocally(*b++);
-      pushedNum++;
-    }
-    heap->fillBufferIfStolen();
+    const unsigned int pushedNum = std::distance(b, e);
+    heaps[tId].data.pushBatch(b, e);
     return pushedNum;
   }
 
   Galois::optional<T> pop() {
-    static thread_local size_t tId = Galois::Runtime::LL::getTID();
+    const size_t tId = Galois::Runtime::LL::getTID();
     auto& buffer = stealBuffers[tId].data;
     if (!buffer.empty()) {
-      auto val = buffer.back();
-      buffer.pop_back();
+      auto val = buffer.pop();
       heaps[tId].data.fillBufferIfStolen();
       return val;
     }
     Galois::optional<T> emptyResult;
     // rand == 0 -- try to steal
     // otherwise, pop locally
-    if (nQ > 1 && random() % StealProb == 0) {
+    if (nQ > 1 && random() % stealProb == 0) {
       Galois::optional<T> stolen = trySteal();
       if (stolen.is_initialized()) return stolen;
     }
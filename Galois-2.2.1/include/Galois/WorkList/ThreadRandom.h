@@ -0,0 +1,43 @@
+#ifndef GALOIS_WORKLIST_THREADRANDOM_H
+#define GALOIS_WORKLIST_THREADRANDOM_H
+
+#include "Galois/Runtime/PerThreadStorage.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace Galois {
+namespace WorkList {
+
+/**
+ * Xorshift random of a worklist. The state of every thread is owned by the
+ * instance and kept in its PerThreadStorage, so that every instance starts
+ * with fresh states, which do not depend on the loops run before.
+ */
+class ThreadRandom {
+  Runtime::PerThreadStorage<uint32_t> state;
+
+public:
+  ThreadRandom() {
+    const uint32_t seed =
+        std::chrono::system_clock::now().time_since_epoch().count() % 16386 + 1;
+    for (unsigned i = 0; i < state.size(); i++) {
+      *state.getRemote(i) = seed + i;
+    }
+  }
+
+  uint32_t operator()() {
+    uint32_t& x = *state.getLocal();
+    uint32_t local_x = x;
+    local_x ^= local_x << 13;
+    local_x ^= local_x >> 17;
+    local_x ^= local_x << 5;
+    x = local_x;
+    return local_x;
+  }
+};
+
+} // namespace WorkList
+} // namespace Galois
+
+#endif // GALOIS_WORKLIST_THREADRANDOM_H
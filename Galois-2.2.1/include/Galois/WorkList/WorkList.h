@@ -41,10 +41,14 @@
 #include "OrderedList.h"
 #include "OwnerComputes.h"
 #include "StableIterator.h"
+#include "PriorityTraits.h"
+#include "LexicographicKey.h"
 #include "MQOptimized/MQOptimizedInclude.h"
 #include "StealingMultiQueue.h"
 #include "StealingMultiQueueNuma.h"
-//#include "experimental_adaptive_mqs/AdaptiveStealingMultiQueue.h"
+#include "AdaptiveStealingMultiQueue.h"
+#include "KLSM.h"
+#include "RelaxationQuality.h"
 
 namespace Galois {
 /**
@@ -37,6 +37,9 @@
 
 #include "k_lsm/k_lsm.h"
 #include "Heap.h"
+#include "PackedHeap.h"
+#include "MQOptimized/NumaQueueMap.h"
+#include "ThreadRandom.h"
 
 #include <random>
 #include <cstdlib>
@@ -939,7 +942,7 @@ template <typename  T,
           size_t D = 4,
           typename Prior = unsigned long>
 struct LockableHeapDAry {
-  boost::heap::d_ary_heap<T, boost::heap::arity<D>, boost::heap::compare<Comparer>> heap;
+  PackedDAryHeap<T, Prior, D> heap;
   std::atomic<Prior> min;
   static T usedT;
 
@@ -999,17 +1002,11 @@ private:
   const size_t nT;
   //! Number of queues.
   const int nQ;
+  ThreadRandom rng;
 
   //! Thread local random.
   uint32_t random() {
-    static thread_local uint32_t x =
-        std::chrono::system_clock::now().time_since_epoch().count() % 16386 + 1;
-    uint32_t local_x = x;
-    local_x ^= local_x << 13;
-    local_x ^= local_x >> 17;
-    local_x ^= local_x << 5;
-    x = local_x;
-    return local_x;
+    return rng();
   }
 
   inline size_t rand_heap() {
@@ -1062,7 +1059,7 @@ public:
       heap = &heaps[q_ind].data;
     } while (!heap->try_lock());
 
-    heap->heap.emplace(val);
+    heap->heap.push(val);
     heap->min.store(heap->heap.top().prior(), ::std::memory_order_release);
     heap->unlock();
   }
@@ -1326,6 +1323,7 @@ private:
 
   const size_t nQ;
   Comparer compare;
+  ThreadRandom rng;
 public:
   typedef T value_type;
 
@@ -1340,7 +1338,7 @@ public:
   };
 
   bool push(const T& key) {
-    static thread_local unsigned tid = Galois::Runtime::LL::getTID();
+    const unsigned tid = Galois::Runtime::LL::getTID();
     return heaps[tid].data.push(key);
   }
 
@@ -1366,12 +1364,7 @@ public:
   }
 
   uint32_t random() {
-    static thread_local uint32_t x =
-        std::chrono::system_clock::now().time_since_epoch().count() % 16386 + 1;
-    x ^= x << 13;
-    x ^= x >> 17;
-    x ^= x << 5;
-    return x;
+    return rng();
   }
 
   inline size_t rand_heap() {
@@ -1446,6 +1439,7 @@ private:
 
   const size_t nQ;
   Comparer compare;
+  ThreadRandom rng;
 public:
   typedef T value_type;
 
@@ -1461,7 +1455,7 @@ public:
 
 
   bool push(const T& key) {
-    static thread_local unsigned tid = Galois::Runtime::LL::getTID();
+    const unsigned tid = Galois::Runtime::LL::getTID();
     return heaps[tid].data.push(key);
   }
 
@@ -1487,12 +1481,7 @@ public:
   }
 
   uint32_t random() {
-    static thread_local uint32_t x =
-        std::chrono::system_clock::now().time_since_epoch().count() % 16386 + 1;
-    x ^= x << 13;
-    x ^= x >> 17;
-    x ^= x << 5;
-    return x;
+    return rng();
   }
   static const size_t C = 1;
   const size_t nT = nQ;
@@ -24,6 +24,8 @@
 #include <cassert>
 #include <utility>
 
+#include "Galois/Runtime/mm/Mem.h"
+#include "Galois/Runtime/ll/TID.h"
 #include "item.h"
 
 namespace kpq
@@ -122,6 +124,11 @@ public:
 private:
     static bool item_owned(const block_item &block_item);
 
+    /** Items of the blocks come from the Galois size class allocators, or
+     *  from large allocations, if they take more than half of a page. */
+    static block_item *alloc_items(const size_t capacity);
+    static void free_items(block_item *items, const size_t capacity);
+
 private:
     /** Points to the lowest known filled index. */
     size_t m_first;
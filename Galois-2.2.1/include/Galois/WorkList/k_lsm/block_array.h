@@ -29,6 +29,7 @@
 #include "xorshf96.h"
 #include "block_pivots.h"
 #include "block_pool.h"
+#include "relaxation.h"
 
 namespace kpq {
 
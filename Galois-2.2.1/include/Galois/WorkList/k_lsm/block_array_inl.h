@@ -108,11 +108,11 @@ block_array<K, V, Rlx>::insert(block<K, V> *new_block,
      * attempt to improve pivots. */
 
     const size_t ncandidates = m_pivots.count(m_size);
-    if (ncandidates > Rlx + 1) {
+    if (ncandidates > relaxation<Rlx>() + 1) {
         // TODO: Possibly a more efficient reset mechanism which uses knowledge of existing
         // pivots.
         m_pivots.shrink(m_blocks, m_size);
-    } else if (ncandidates < Rlx / 2) {
+    } else if (ncandidates < relaxation<Rlx>() / 2) {
         m_pivots.grow(ncandidates, m_blocks, m_size);
     }
 }
@@ -229,7 +229,7 @@ block_array<K, V, Rlx>::peek()
 
         /* If the range contains too few items, attempt to improve it. */
 
-        if (ncandidates < Rlx / 2) {
+        if (ncandidates < relaxation<Rlx>() / 2) {
             ncandidates = m_pivots.grow(ncandidates, m_blocks, m_size);
         }
 
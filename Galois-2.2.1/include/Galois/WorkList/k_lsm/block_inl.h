@@ -49,7 +49,7 @@ block<K, V>::block(const size_t power_of_2) :
     m_power_of_2(power_of_2),
     m_capacity(1 << power_of_2),
     m_owner_tid(Galois::Runtime::LL::getTID()),
-    m_block_items(new block_item[m_capacity]),
+    m_block_items(alloc_items(m_capacity)),
     m_used(false)
 {
 }
@@ -57,7 +57,33 @@ block<K, V>::block(const size_t power_of_2) :
 template <class K, class V>
 block<K, V>::~block()
 {
-    delete[] m_block_items;
+    free_items(m_block_items, m_capacity);
+}
+
+template <class K, class V>
+typename block<K, V>::block_item *
+block<K, V>::alloc_items(const size_t capacity)
+{
+    namespace MM = Galois::Runtime::MM;
+    const size_t bytes = capacity * sizeof(block_item);
+    void *mem = (bytes <= MM::pageSize / 2)
+              ? MM::SizedAllocatorFactory::getAllocatorForSize(bytes)->allocate(bytes)
+              : MM::largeAlloc(bytes, false);
+    return static_cast<block_item *>(mem);
+}
+
+template <class K, class V>
+void
+block<K, V>::free_items(block_item *items,
+                        const size_t capacity)
+{
+    namespace MM = Galois::Runtime::MM;
+    const size_t bytes = capacity * sizeof(block_item);
+    if (bytes <= MM::pageSize / 2) {
+        MM::SizedAllocatorFactory::getAllocatorForSize(bytes)->deallocate(items);
+    } else {
+        MM::largeFree(items, bytes);
+    }
 }
 
 template <class K, class V>
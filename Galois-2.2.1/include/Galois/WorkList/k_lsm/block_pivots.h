@@ -20,6 +20,8 @@
 #ifndef __BLOCK_PIVOTS_H
 #define __BLOCK_PIVOTS_H
 
+#include "relaxation.h"
+
 namespace kpq {
 
 // TODO: Better naming, pivots is very undescriptive to me. Item range? Index boundaries
@@ -179,7 +179,7 @@ block_pivots<K, V, Rlx, MaxBlocks>::resize(const int initial_range_size,
                     }
                 }
 
-                if (CORRECTED_TENTATIVE_COUNT() > Rlx + 1) {
+                if (CORRECTED_TENTATIVE_COUNT() > relaxation<Rlx>() + 1) {
                     tentative_pivots[block_ix] = pivot;
                     goto outer;
                 }
@@ -188,12 +188,12 @@ block_pivots<K, V, Rlx, MaxBlocks>::resize(const int initial_range_size,
         }
 
 outer:
-        if (CORRECTED_TENTATIVE_COUNT() > Rlx + 1) {
+        if (CORRECTED_TENTATIVE_COUNT() > relaxation<Rlx>() + 1) {
             if (upper_bound == mid) {
                 goto out;
             }
             upper_bound = std::min(mid, maximal_key);
-        } else if (elements_in_tentative_range < Rlx / 2) {
+        } else if (elements_in_tentative_range < relaxation<Rlx>() / 2) {
             if (lower_bound == mid) {
                 break;  // Could not improve solution further.
             }
@@ -276,7 +276,7 @@ int
 block_pivots<K, V, Rlx, MaxBlocks>::pivot_of(block<K, V> *block) const
 {
     const size_t first = block->first();
-    const size_t upper_bound = std::min(first + Rlx + 1, block->last());
+    const size_t upper_bound = std::min(first + relaxation<Rlx>() + 1, block->last());
     for (size_t i = first; i < upper_bound; i++) {
         auto p = block->peek_nth(i);
         if (!p->taken() && p->m_key > m_maximal_pivot) {
@@ -26,6 +26,7 @@
 #include "item.h"
 #include "counters.h"
 #include "mm.h"
+#include "relaxation.h"
 #include "xorshf96.h"
 
 namespace kpq
@@ -0,0 +1,32 @@
+/*
+ *  Relaxation of the k-lsm, which may be chosen at runtime.
+ */
+
+#ifndef __RELAXATION_H
+#define __RELAXATION_H
+
+namespace kpq
+{
+
+/** Rlx of the queues, whose relaxation is read from dynamic_relaxation(). */
+constexpr int DYNAMIC_RLX = 0;
+
+/**
+ * Relaxation of the queues with Rlx == DYNAMIC_RLX. It must not change
+ * while such a queue keeps items.
+ */
+inline int &dynamic_relaxation()
+{
+    static int value = 256;
+    return value;
+}
+
+template <int Rlx>
+inline int relaxation()
+{
+    return Rlx == DYNAMIC_RLX ? dynamic_relaxation() : Rlx;
+}
+
+}
+
+#endif /* __RELAXATION_H */
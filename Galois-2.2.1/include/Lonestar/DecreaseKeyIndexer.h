@@ -0,0 +1,52 @@
+/** Indexer of the decrease-key worklists for the benchmarks -*- C++ -*-
+ * @file
+ * @section License
+ *
+ * Galois, a framework to exploit amorphous data-parallelism in irregular
+ * programs.
+ *
+ * Copyright (C) 2013, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+#ifndef LONESTAR_DECREASEKEYINDEXER_H
+#define LONESTAR_DECREASEKEYINDEXER_H
+
+#include <atomic>
+#include <stdint.h>
+#include <utility>
+
+/**
+ * Keeps the position of a work item in a DecreaseKeyHeap in the data of
+ * its node `wi.n`, which needs a `std::atomic<uint64_t> index` field
+ * initialized to 0. The index is in the high half, the queue + 1 in
+ * the low half, so 0 means no queue.
+ */
+template <typename WorkItem>
+struct DecreaseKeyIndexer {
+  static int get_queue(WorkItem const& wi) {
+    return get_pair(wi).first;
+  }
+
+  static void set_pair(WorkItem const& wi, int q, uint32_t ind) {
+    wi.n->getData().index.store((uint64_t(ind) << 32) | uint32_t(q + 1), std::memory_order_release);
+  }
+
+  static std::pair<int, uint32_t> get_pair(WorkItem const& wi) {
+    const uint64_t index = wi.n->getData().index.load(std::memory_order_acquire);
+    const uint64_t mask = (uint64_t(1) << 32) - 1;
+    int q = index & mask;
+    return {q - 1, index >> 32};
+  }
+};
+
+#endif
@@ -0,0 +1,88 @@
+/** Common command line options of the schedulers -*- C++ -*-
+ * @file
+ * @section License
+ *
+ * Galois, a framework to exploit amorphous data-parallelism in irregular
+ * programs.
+ *
+ * Copyright (C) 2012, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ */
+#ifndef LONESTAR_SCHEDULEROPTIONS_H
+#define LONESTAR_SCHEDULEROPTIONS_H
+
+#include "Galois/Galois.h"
+#include "llvm/Support/CommandLine.h"
+
+//! options of the runtime parameterized worklists, shared by the benchmarks
+static llvm::cl::opt<std::string> mqSuff("suff", llvm::cl::desc("Suffix for amq or smq"), llvm::cl::init(""));
+static llvm::cl::opt<unsigned int> stealProb("stealProb", llvm::cl::desc("Steal with 1 / stealProb probability in smq, initial value in asmq"), llvm::cl::init(8));
+static llvm::cl::opt<unsigned int> stealBatch("stealBatch", llvm::cl::desc("Number of elements to steal at once in smq, initial value in asmq"), llvm::cl::init(8));
+static llvm::cl::opt<unsigned int> stealSlice("stealSlice", llvm::cl::desc("Maximum number of elements to claim from a steal buffer at once in smq, 0 -- whole buffer"), llvm::cl::init(0));
+static llvm::cl::opt<unsigned int> stealCoreProb("stealCoreProb", llvm::cl::desc("Probability in percents to steal from an SMT sibling first in smq"), llvm::cl::init(0));
+static llvm::cl::opt<unsigned int> stealPackageProb("stealPackageProb", llvm::cl::desc("Probability in percents to steal from the same package first in smq"), llvm::cl::init(0));
+static llvm::cl::opt<unsigned int> numaWeight("numaWeight", llvm::cl::desc("Weight of a queue on the local NUMA node in smqnuma and policymqnuma"), llvm::cl::init(1));
+static llvm::cl::opt<unsigned int> mqC("mqC", llvm::cl::desc("Number of queues per thread in policymq"), llvm::cl::init(2));
+static llvm::cl::opt<Galois::WorkList::MultiQueuePolicy::Insert> mqInsert("mqInsert", llvm::cl::desc("Insert policy of policymq:"),
+    llvm::cl::values(
+      clEnumValN(Galois::WorkList::MultiQueuePolicy::RANDOM_INSERT, "random", "Random queue for every element"),
+      clEnumValN(Galois::WorkList::MultiQueuePolicy::TEMPORAL_INSERT, "temporal", "Change the queue with 1 / mqInsertParam probability (default)"),
+      clEnumValN(Galois::WorkList::MultiQueuePolicy::BATCHING_INSERT, "batching", "Push mqInsertParam elements at once"),
+      clEnumValEnd), llvm::cl::init(Galois::WorkList::MultiQueuePolicy::TEMPORAL_INSERT));
+static llvm::cl::opt<unsigned int> mqInsertParam("mqInsertParam", llvm::cl::desc("Parameter of the insert policy of policymq"), llvm::cl::init(8));
+static llvm::cl::opt<Galois::WorkList::MultiQueuePolicy::Delete> mqDelete("mqDelete", llvm::cl::desc("Delete policy of policymq:"),
+    llvm::cl::values(
+      clEnumValN(Galois::WorkList::MultiQueuePolicy::TWO_CHOICE_DELETE, "choice", "Best of the random queues"),
+      clEnumValN(Galois::WorkList::MultiQueuePolicy::TEMPORAL_DELETE, "temporal", "Change the queue with 1 / mqDeleteParam probability (default)"),
+      clEnumValN(Galois::WorkList::MultiQueuePolicy::BATCHING_DELETE, "batching", "Take mqDeleteParam elements at once"),
+      clEnumValEnd), llvm::cl::init(Galois::WorkList::MultiQueuePolicy::TEMPORAL_DELETE));
+static llvm::cl::opt<unsigned int> mqDeleteParam("mqDeleteParam", llvm::cl::desc("Parameter of the delete policy of policymq"), llvm::cl::init(8));
+static llvm::cl::opt<unsigned int> mqMaxC("mqMaxC", llvm::cl::desc("Maximal number of queues per thread in the policy multiqueues, 0 -- the number is fixed"), llvm::cl::init(0));
+static llvm::cl::opt<unsigned int> mqChoices("mqChoices", llvm::cl::desc("Number of queues compared by a pop in the policy multiqueues"), llvm::cl::init(2));
+static llvm::cl::opt<unsigned int> mqSticky("mqSticky", llvm::cl::desc("Number of pops comparing the same queues in the policy multiqueues"), llvm::cl::init(1));
+static llvm::cl::opt<bool> mqPrefetch("mqPrefetch", llvm::cl::desc("Prefetch the minimums of the compared queues in the policy multiqueues"), llvm::cl::init(false));
+static llvm::cl::opt<unsigned int> klsmK("klsmK", llvm::cl::desc("Relaxation k of klsm"), llvm::cl::init(256));
+static llvm::cl::opt<unsigned int> obimRetire("obimRetire", llvm::cl::desc("Number of created bins, after which obim retires the bins behind all the threads, 0 -- never"), llvm::cl::init(4096));
+static llvm::cl::opt<bool> obimAdaptiveDelta("obimAdaptiveDelta", llvm::cl::desc("Let obim merge its bins at runtime like adapobim"), llvm::cl::init(false));
+static llvm::cl::opt<unsigned int> deltaTarget("deltaTarget", llvm::cl::desc("Pushes per bin, which the adaptive delta aims at, 0 -- the chunk size"), llvm::cl::init(0));
+static llvm::cl::opt<bool> deltaUnmerge("deltaUnmerge", llvm::cl::desc("Let the adaptive delta split the bins again"), llvm::cl::init(false));
+static llvm::cl::opt<unsigned int> chunkSize("chunkSize", llvm::cl::desc("Items per chunk of the chunked worklists, capped by CHUNK_SIZE, 0 -- CHUNK_SIZE"), llvm::cl::init(0));
+static llvm::cl::opt<unsigned int> parkAfter("parkAfter", llvm::cl::desc("Number of rounds without work, after which an idle thread sleeps, 0 -- never"), llvm::cl::init(0));
+static llvm::cl::opt<bool> relaxationStats("relaxationStats", llvm::cl::desc("Report rank error and delay histograms of the worklist"), llvm::cl::init(false));
+
+//! pass the scheduler options to the worklists, call after LonestarStart
+static void applySchedulerOptions() {
+  using namespace Galois::WorkList;
+
+  StealingMultiQueueParams::stealProb() = stealProb;
+  StealingMultiQueueParams::stealBatchSize() = stealBatch;
+  StealingMultiQueueParams::stealSliceSize() = stealSlice;
+  StealingMultiQueueParams::stealCoreProb() = stealCoreProb;
+  StealingMultiQueueParams::stealPackageProb() = stealPackageProb;
+  NumaParams::localWeight() = numaWeight;
+  MultiQueueParams::queuesPerThread() = mqC;
+  MultiQueueParams::policy() = {mqInsert, mqInsertParam, mqDelete, mqDeleteParam};
+  MultiQueueParams::maxQueuesPerThread() = mqMaxC;
+  MultiQueueParams::popChoices() = mqChoices;
+  MultiQueueParams::popStickiness() = mqSticky;
+  MultiQueueParams::prefetchChoices() = mqPrefetch;
+  KLSMParams::k() = klsmK;
+  OBIMParams::retireAfter() = obimRetire;
+  OBIMParams::adaptiveDelta() = obimAdaptiveDelta;
+  AdaptiveDeltaParams::pushesPerBin() = deltaTarget;
+  AdaptiveDeltaParams::unmerge() = deltaUnmerge;
+  ChunkedParams::chunkSize() = chunkSize;
+  Galois::Runtime::IdleParkingParams::parkAfter() = parkAfter;
+}
+
+#endif
@@ -28,6 +28,7 @@
  */
 
 #include "Galois/Runtime/ActiveThreads.h"
+#include "Galois/Runtime/IdleParking.h"
 #include "Galois/Runtime/Termination.h"
 #include "Galois/Runtime/ll/CompilerSpecific.h"
 
@@ -51,11 +52,14 @@ class LocalTerminationDetection : public TerminationDetection {
   //send token onwards
   void propToken(bool isBlack, int epoch) {
     unsigned id = LL::getTID();
-    TokenHolder& th = *data.getRemote((id + 1) % activeThreads);
+    unsigned next = (id + 1) % activeThreads;
+    TokenHolder& th = *data.getRemote(next);
     th.tokenIsBlack = isBlack;
     th.epoch = epoch;
     LL::compilerBarrier();
     th.hasToken = true;
+    if (parking)
+      parking->wake(next);
   }
 
   void propGlobalTerm() {
@@ -171,6 +175,8 @@ class TreeTerminationDetection : public TerminationDetection {
 	th.down_token = true;
       } else {
 	data.getRemote(th.parent)->up_token[th.parent_offset] = black;
+	if (parking)
+	  parking->wake(th.parent);
       }
     }
 
@@ -180,8 +186,11 @@ class TreeTerminationDetection : public TerminationDetection {
       th.hasToken = true;
       for (int i = 0; i < num; ++i) {
 	th.up_token[i] = -1;
-	if (th.child[i])
+	if (th.child[i]) {
 	  th.child[i]->down_token = true;
+	  if (parking)
+	    parking->wake(LL::getTID() * num + i + 1);
+	}
       }
     }
   }
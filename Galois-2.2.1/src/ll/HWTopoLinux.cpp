@@ -224,6 +224,7 @@ struct AutoLinuxPolicy {
   unsigned numPackages, numPackagesRaw;
 
   std::vector<int> packages;
+  std::vector<int> cores;
   std::vector<int> maxPackage;
   std::vector<int> virtmap;
   std::vector<int> leaders;
@@ -287,6 +288,7 @@ struct AutoLinuxPolicy {
 
     //Get core count
     numCores = generateCoreData(vals);
+    finalizeCoreData(vals);
  
     //Compute cummulative max package
     int p = 0;
@@ -326,6 +328,7 @@ struct AutoLinuxPolicy {
       gPrint(
           "T ", i, 
           " P ", packages[i],
+          " C ", cores[i],
           " Tr ", virtmap[i], 
           " L? ", ((int)i == leaders[packages[i]] ? 1 : 0));
       if (i >= numCores)
@@ -345,6 +348,18 @@ struct AutoLinuxPolicy {
     }
   }
 
+  void finalizeCoreData(const std::vector<cpuinfo>& vals) {
+    //Real cores come first, so hyperthreads get the id of their first sibling
+    std::vector<std::pair<int, int> > seen;
+    for (unsigned i = 0; i < virtmap.size(); ++i) {
+      std::pair<int, int> core(vals[virtmap[i]].physid, vals[virtmap[i]].coreid);
+      std::vector<std::pair<int, int> >::iterator it = std::find(seen.begin(), seen.end(), core);
+      cores.push_back(std::distance(seen.begin(), it));
+      if (it == seen.end())
+        seen.push_back(core);
+    }
+  }
+
   unsigned generateCoreData(const std::vector<cpuinfo>& vals) {
     std::vector<std::pair<int, int> > cores;
     //first get the raw numbers
@@ -437,6 +452,11 @@ unsigned Galois::Runtime::LL::getPackageForThread(int id) {
   return getPolicy().packages[id];
 }
 
+unsigned Galois::Runtime::LL::getCoreForThread(int id) {
+  assert(id < (int)getPolicy().cores.size());
+  return getPolicy().cores[id];
+}
+
 unsigned Galois::Runtime::LL::getMaxPackageForThread(int id) {
   assert(id < (int)getPolicy().maxPackage.size());
   return getPolicy().maxPackage[id];
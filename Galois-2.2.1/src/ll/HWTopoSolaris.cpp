@@ -104,6 +104,10 @@ unsigned Galois::Runtime::LL::getPackageForThread(int id) {
   return 0;
 }
 
+unsigned Galois::Runtime::LL::getCoreForThread(int id) {
+  return id;
+}
+
 bool Galois::Runtime::LL::isPackageLeader(int id) {
   return id == 0;
 }
@@ -0,0 +1,80 @@
+#include "Galois/WorkList/BinDirectory.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+using namespace Galois::WorkList;
+
+struct Bin {
+  int index;
+};
+
+//! Installs bins for negative and positive priorities, checks the lookups,
+//! the order of the walk and the retirement below a frontier.
+template<typename Index>
+bool check(std::vector<Index> const& indices, Index frontier) {
+  BinDirectory<Index, Bin> dir;
+  std::vector<Bin> bins(indices.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    bins[i].index = i;
+    if (dir.install(indices[i], &bins[i]) != &bins[i]) {
+      std::cerr << "install failed for " << indices[i] << "\n";
+      return false;
+    }
+  }
+  Bin other;
+  if (dir.install(indices[0], &other) != &bins[0] || dir.get(indices[0]) != &bins[0]) {
+    std::cerr << "second install replaced the bin\n";
+    return false;
+  }
+
+  std::vector<Index> walked;
+  dir.findFrom(std::numeric_limits<Index>::min(), [&](Index i, Bin* b) {
+    walked.push_back(i);
+    return dir.get(i) != b;
+  });
+  std::vector<Index> sorted(indices);
+  std::sort(sorted.begin(), sorted.end());
+  if (walked != sorted) {
+    std::cerr << "walk is not ordered\n";
+    return false;
+  }
+
+  std::vector<Bin*> retired;
+  std::vector<typename BinDirectory<Index, Bin>::Node*> nodes;
+  dir.retireBelow(frontier, retired, nodes);
+  size_t below = 0;
+  for (size_t i = 0; i < indices.size(); ++i) {
+    const bool gone = dir.get(indices[i]) == nullptr;
+    below += indices[i] < frontier;
+    if (gone != (indices[i] < frontier)) {
+      std::cerr << "wrong retirement of " << indices[i] << "\n";
+      return false;
+    }
+  }
+  if (retired.size() != below) {
+    std::cerr << "retired " << retired.size() << " bins instead of " << below << "\n";
+    return false;
+  }
+  // Retired priorities can get new bins.
+  if (dir.install(sorted[0], &other) != &other) {
+    std::cerr << "install after retirement failed\n";
+    return false;
+  }
+  for (auto* n : nodes)
+    delete n;
+  return true;
+}
+
+int main() {
+  bool ok = true;
+  ok &= check<int>({-100000, -3, 0, 5, 255, 256, 70000, 1 << 30}, 256);
+  ok &= check<int>({-7, -6, 4}, std::numeric_limits<int>::max());
+  ok &= check<unsigned>({1, 2, 3, 1000, 1u << 31}, 3);
+  ok &= check<long>({-(1l << 40), 12, 1l << 40}, 13);
+
+  std::cout << (ok ? "OK" : "FAILED") << "\n";
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#include "Galois/Galois.h"
+#include "Galois/WorkList/KLSM.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace Galois::WorkList;
+
+struct Indexer {
+  unsigned long operator()(unsigned long v) const {
+    return v / 3;
+  }
+};
+
+//! Pushes the elements in batches and one by one, popping some of them
+//! in between, and checks that every element is returned once.
+template<typename WL>
+bool check(WL& wl, size_t num) {
+  std::vector<unsigned long> elements;
+  for (unsigned long i = 0; i < num; ++i)
+    elements.push_back((i * 7919) % num);
+
+  std::vector<int> seen(num, 0);
+  size_t popped = 0;
+  auto popSome = [&](size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      auto val = wl.pop();
+      if (!val)
+        return true;
+      if (*val >= num || seen[*val]++) {
+        std::cerr << "unexpected element " << *val << "\n";
+        return false;
+      }
+      popped++;
+    }
+    return true;
+  };
+
+  wl.push(elements.begin(), elements.begin() + num / 2);
+  if (!popSome(num / 8))
+    return false;
+  for (size_t i = num / 2; i < num; ++i) {
+    wl.push(elements[i]);
+    if (i % 5 == 0 && !popSome(1))
+      return false;
+  }
+  if (!popSome(num))
+    return false;
+  if (wl.pop()) {
+    std::cerr << "element after the last one\n";
+    return false;
+  }
+  for (size_t i = 0; i < num; ++i) {
+    if (!seen[i]) {
+      std::cerr << "lost element " << i << "\n";
+      return false;
+    }
+  }
+  return popped == num;
+}
+
+int main() {
+  bool ok = true;
+
+  KLSM<unsigned long, Indexer, 2> klsm2;
+  ok &= check(klsm2, 1000);
+
+  KLSM<unsigned long, Indexer, 16> klsm16;
+  ok &= check(klsm16, 1000);
+
+  // A static relaxation below 2 is raised to 2.
+  KLSM<unsigned long, Indexer, 1> klsm1;
+  ok &= check(klsm1, 1000);
+
+  for (size_t k : {0, 1, 2, 7, 256}) {
+    KLSMParams::k() = k;
+    KLSM<unsigned long, Indexer> rklsm;
+    ok &= check(rklsm, 1000);
+  }
+
+  std::cout << (ok ? "OK" : "FAILED") << "\n";
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,454 @@
+#include "Galois/Galois.h"
+#include "Galois/WorkList/WorkList.h"
+
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+using namespace Galois::WorkList;
+
+struct Prioritized {
+  unsigned long id;
+
+  unsigned long prior() const {
+    return id;
+  }
+};
+
+struct PriorComparer {
+  bool operator()(Prioritized const& a, Prioritized const& b) const {
+    return a.prior() > b.prior();
+  }
+};
+
+//! Element without `prior()`, its priority is given by PriorityTraits.
+struct Weighted {
+  float weight;
+};
+
+namespace Galois {
+namespace WorkList {
+template<>
+struct PriorityTraits<Weighted> {
+  static float prior(Weighted const& w) {
+    return w.weight;
+  }
+};
+} // namespace WorkList
+} // namespace Galois
+
+struct WeightComparer {
+  bool operator()(Weighted const& a, Weighted const& b) const {
+    return a.weight > b.weight;
+  }
+};
+
+//! Pushes the elements in batches and pops some of them after every
+//! batch, changing the policies in between. Checks that every element
+//! is returned once.
+bool check(std::vector<MultiQueuePolicy> const& policies, size_t num) {
+  PolicyMultiQueue<Prioritized, PriorComparer> wl;
+  std::vector<Prioritized> elements;
+  for (unsigned long i = 0; i < num; ++i)
+    elements.push_back({(i * 7919) % num});
+
+  std::vector<int> seen(num, 0);
+  size_t popped = 0;
+  auto popSome = [&](size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      auto val = wl.pop();
+      if (!val) return true;
+      popped++;
+      if (val->id >= num || seen[val->id]++) {
+        std::cerr << "unexpected element " << val->id << "\n";
+        return false;
+      }
+    }
+    return true;
+  };
+
+  const size_t batch = 37;
+  for (size_t b = 0, p = 0; b < num; b += batch, p = (p + 1) % policies.size()) {
+    wl.setPolicy(policies[p]);
+    wl.push(elements.begin() + b, elements.begin() + std::min(num, b + batch));
+    if (!popSome(batch / 2)) return false;
+  }
+  if (!popSome(num)) return false;
+  if (popped != num) {
+    std::cerr << "lost " << num - popped << " elements\n";
+    return false;
+  }
+  return true;
+}
+
+//! Elements held by BATCHING_INSERT are pushed, when the thread pops.
+bool checkBoundedDelay() {
+  MultiQueuePolicy policy;
+  policy.insert = MultiQueuePolicy::RANDOM_INSERT;
+  policy.remove = MultiQueuePolicy::TWO_CHOICE_DELETE;
+  PolicyMultiQueue<Prioritized, PriorComparer> wl;
+  wl.setPolicy(policy);
+  // A worse element in the queues.
+  std::vector<Prioritized> elements{{50}};
+  wl.push(elements.begin(), elements.end());
+  elements.clear();
+  policy.insert = MultiQueuePolicy::BATCHING_INSERT;
+  policy.insertParam = 100;
+  wl.setPolicy(policy);
+  for (unsigned long i = 10; i > 0; --i)
+    elements.push_back({i});
+  wl.push(elements.begin(), elements.end());
+  auto val = wl.pop();
+  if (!val || val->id != 1) {
+    std::cerr << "buffered elements are not popped\n";
+    return false;
+  }
+  return true;
+}
+
+//! Elements of the removed queues are moved to the others.
+bool checkResize(size_t num) {
+  MultiQueueParams::maxQueuesPerThread() = 8;
+  PolicyMultiQueue<Prioritized, PriorComparer, 4> wl;
+  MultiQueueParams::maxQueuesPerThread() = 0;
+  std::vector<Prioritized> elements;
+  for (unsigned long i = 0; i < num; ++i)
+    elements.push_back({i});
+  wl.push(elements.begin(), elements.begin() + num / 2);
+  wl.setQueueNumber(8);
+  wl.push(elements.begin() + num / 2, elements.end());
+  wl.setQueueNumber(1);
+  if (wl.queueNumber() != 1) {
+    std::cerr << "queue number is not changed\n";
+    return false;
+  }
+  // All the elements are in one queue now.
+  for (unsigned long i = 0; i < num; ++i) {
+    auto val = wl.pop();
+    if (!val || val->id != i) {
+      std::cerr << "element " << i << " is lost\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+typedef HeapWithLock<Prioritized> LockedHeap;
+
+//! Elements deferred onto a locked heap are in its minimum at once and
+//! popped by the lock holder.
+bool checkDeferredPush() {
+  LockedHeap heap;
+  heap.lock();
+  heap.push(Prioritized{3});
+  heap.updateMin();
+  std::vector<Prioritized> five{{5}}, one{{1}};
+  heap.deferPush(five.begin(), five.end());
+  if (heap.getMin() != 3) {
+    std::cerr << "deferred element lowers the minimum\n";
+    return false;
+  }
+  heap.deferPush(one.begin(), one.end());
+  if (heap.getMin() != 1) {
+    std::cerr << "deferred element is not in the minimum\n";
+    return false;
+  }
+  heap.updateMin();
+  for (unsigned long expected : {1, 3, 5}) {
+    if (heap.empty() || heap.extractMin().id != expected) {
+      std::cerr << "deferred element " << expected << " is not popped\n";
+      return false;
+    }
+    heap.updateMin();
+  }
+  const bool empty = LockedHeap::isMinEmpty(heap.getMin());
+  heap.unlock();
+  if (!empty) {
+    std::cerr << "drained heap is not empty\n";
+    return false;
+  }
+  return true;
+}
+
+//! A deferral longer than a block is merged whole.
+bool checkLongDeferredPush(size_t num) {
+  LockedHeap heap;
+  std::vector<Prioritized> elements;
+  for (unsigned long i = 0; i < num; ++i)
+    elements.push_back({(i * 7919) % num});
+  heap.deferPush(elements.begin(), elements.end());
+  if (heap.getMin() != 0) {
+    std::cerr << "long deferral does not lower the minimum\n";
+    return false;
+  }
+  heap.lock();
+  for (unsigned long i = 0; i < num; ++i) {
+    if (heap.empty() || heap.extractMin().id != i) {
+      std::cerr << "deferred element " << i << " is lost\n";
+      heap.unlock();
+      return false;
+    }
+  }
+  const bool empty = heap.empty();
+  heap.unlock();
+  if (!empty) {
+    std::cerr << "long deferral is merged twice\n";
+    return false;
+  }
+  return true;
+}
+
+//! A lock holder draining the heap while the other threads defer to it
+//! never publishes it as empty while it keeps deferred elements.
+bool checkConcurrentDeferredPush(size_t num) {
+  LockedHeap heap;
+  std::atomic<unsigned> pushersDone{0};
+  size_t drained = 0;
+  Galois::on_each([&](unsigned tid, unsigned total) {
+    // The first thread holds the lock, unless it is the only one.
+    const unsigned pushers = total > 1 ? total - 1 : 1;
+    if (tid > 0 || total == 1) {
+      for (unsigned long i = total > 1 ? tid - 1 : 0; i < num; i += pushers) {
+        Prioritized element{i};
+        heap.deferPush(&element, &element + 1);
+      }
+      pushersDone++;
+    }
+    if (tid == 0) {
+      do {
+        heap.lock();
+        while (!heap.empty()) {
+          heap.extractMin();
+          drained++;
+        }
+        heap.updateMin();
+        heap.unlock();
+      } while (pushersDone.load() < pushers);
+    }
+  });
+  const bool minEmpty = LockedHeap::isMinEmpty(heap.getMin());
+  std::vector<Prioritized> rest;
+  heap.lock();
+  heap.extractAll(rest);
+  heap.unlock();
+  if (drained + rest.size() != num) {
+    std::cerr << "lost " << num - drained - rest.size() << " deferred elements\n";
+    return false;
+  }
+  if (minEmpty && !rest.empty()) {
+    std::cerr << "heap with deferred elements is published as empty\n";
+    return false;
+  }
+  return true;
+}
+
+//! Threads push while the number of queues changes, the elements
+//! deferred to the removed queues are moved to the others.
+bool checkConcurrentResize(size_t num) {
+  MultiQueueParams::maxQueuesPerThread() = 8;
+  PolicyMultiQueue<Prioritized, PriorComparer, 1> wl;
+  MultiQueueParams::maxQueuesPerThread() = 0;
+  Galois::on_each([&](unsigned tid, unsigned total) {
+    for (unsigned long i = tid; i < num; i += total) {
+      if (i % 64 == 0)
+        wl.setQueueNumber(i % 128 == 0 ? 1 : 8 * total);
+      Prioritized element{i};
+      wl.push(&element, &element + 1);
+    }
+  });
+  wl.setQueueNumber(1);
+  std::vector<int> seen(num, 0);
+  size_t popped = 0;
+  // A pop can miss the elements, if there are several queues.
+  for (size_t misses = 0; popped < num && misses < 1000;) {
+    auto val = wl.pop();
+    if (!val) {
+      misses++;
+      continue;
+    }
+    if (val->id >= num || seen[val->id]++) {
+      std::cerr << "unexpected element " << val->id << "\n";
+      return false;
+    }
+    popped++;
+  }
+  if (popped != num) {
+    std::cerr << "lost " << num - popped << " elements by a resize\n";
+    return false;
+  }
+  return true;
+}
+
+//! Floating point priorities, including the negative ones.
+bool checkFloatPriorities(size_t num) {
+  PolicyMultiQueue<Weighted, WeightComparer, 2, float> wl;
+  wl.setQueueNumber(1);
+  std::vector<Weighted> elements;
+  for (size_t i = 0; i < num; ++i)
+    elements.push_back({((i * 7919) % num) / 4.0f - 100.0f});
+  wl.push(elements.begin(), elements.end());
+  float last = -1000.0f;
+  for (size_t i = 0; i < num; ++i) {
+    auto val = wl.pop();
+    if (!val || val->weight < last) {
+      std::cerr << "float priorities are out of order\n";
+      return false;
+    }
+    last = val->weight;
+  }
+  return !wl.pop();
+}
+
+//! Element with a 128-bit priority.
+struct Wide {
+  unsigned __int128 key;
+
+  unsigned __int128 prior() const {
+    return key;
+  }
+};
+
+struct WideComparer {
+  bool operator()(Wide const& a, Wide const& b) const {
+    return a.key > b.key;
+  }
+};
+
+//! 128-bit priorities, which differ only above the lower 64 bits.
+bool checkWidePriorities(size_t num) {
+  PolicyMultiQueue<Wide, WideComparer, 2, unsigned __int128> wl;
+  wl.setQueueNumber(1);
+  std::vector<Wide> elements;
+  for (size_t i = 0; i < num; ++i)
+    elements.push_back({(unsigned __int128) ((i * 7919) % num) << 64});
+  wl.push(elements.begin(), elements.end());
+  for (size_t i = 0; i < num; ++i) {
+    auto val = wl.pop();
+    if (!val || val->key != (unsigned __int128) i << 64) {
+      std::cerr << "128-bit priorities are out of order\n";
+      return false;
+    }
+  }
+  return !wl.pop();
+}
+
+//! Two-level priority (level, weight) packed into one word.
+typedef LexicographicKey<24, 39> LevelWeight;
+
+struct Tiered {
+  unsigned level;
+  unsigned long weight;
+
+  LevelWeight::type prior() const {
+    return LevelWeight::pack(level, weight);
+  }
+};
+
+struct TieredComparer {
+  bool operator()(Tiered const& a, Tiered const& b) const {
+    return a.prior() > b.prior();
+  }
+};
+
+//! Elements are popped in the lexicographic order of the levels.
+bool checkLexicographicKeys() {
+  if (LevelWeight::get<0>(LevelWeight::pack(5, 7)) != 5
+      || LevelWeight::get<1>(LevelWeight::pack(5, 7)) != 7
+      || LevelWeight::pack(1, 1ul << 40) != LevelWeight::pack(1, (1ul << 39) - 1)) {
+    std::cerr << "levels are packed wrong\n";
+    return false;
+  }
+  PolicyMultiQueue<Tiered, TieredComparer, 2, LevelWeight::type> wl;
+  wl.setQueueNumber(1);
+  std::vector<Tiered> elements;
+  for (unsigned level = 0; level < 10; ++level)
+    for (unsigned long weight = 0; weight < 10; ++weight)
+      elements.push_back({9 - level, (weight * 7) % 10 + (1ul << 35)});
+  wl.push(elements.begin(), elements.end());
+  Tiered last{0, 0};
+  for (size_t i = 0; i < elements.size(); ++i) {
+    auto val = wl.pop();
+    if (!val || val->level < last.level
+        || (val->level == last.level && val->weight < last.weight)) {
+      std::cerr << "levels are out of order\n";
+      return false;
+    }
+    last = *val;
+  }
+  return true;
+}
+
+//! Keys with the highest bit of the top level set are not published as
+//! empty queues.
+bool checkHighLexicographicKeys(size_t num) {
+  PolicyMultiQueue<Tiered, TieredComparer, 2, LevelWeight::type> wl;
+  std::vector<Tiered> elements;
+  for (size_t i = 0; i < num; ++i)
+    elements.push_back({(1u << 23) + (unsigned) (i % 7), i});
+  wl.push(elements.begin(), elements.end());
+  std::vector<int> seen(num, 0);
+  size_t popped = 0;
+  for (size_t misses = 0; popped < num && misses < 1000;) {
+    auto val = wl.pop();
+    if (!val) {
+      misses++;
+      continue;
+    }
+    if (val->weight >= num || seen[val->weight]++) {
+      std::cerr << "unexpected element " << val->weight << "\n";
+      return false;
+    }
+    popped++;
+  }
+  if (popped != num) {
+    std::cerr << "lost " << num - popped << " elements with high levels\n";
+    return false;
+  }
+  return true;
+}
+
+int main() {
+  bool ok = true;
+  const MultiQueuePolicy::Insert inserts[] = {MultiQueuePolicy::RANDOM_INSERT,
+                                              MultiQueuePolicy::TEMPORAL_INSERT,
+                                              MultiQueuePolicy::BATCHING_INSERT};
+  const MultiQueuePolicy::Delete deletes[] = {MultiQueuePolicy::TWO_CHOICE_DELETE,
+                                              MultiQueuePolicy::TEMPORAL_DELETE,
+                                              MultiQueuePolicy::BATCHING_DELETE};
+  std::vector<MultiQueuePolicy> all;
+  for (auto insert : inserts) {
+    for (auto remove : deletes) {
+      MultiQueuePolicy policy;
+      policy.insert = insert;
+      policy.insertParam = 5;
+      policy.remove = remove;
+      policy.deleteParam = 4;
+      ok &= check({policy}, 1000);
+      all.push_back(policy);
+    }
+  }
+  // Buffered elements survive the change of the policies.
+  ok &= check(all, 1000);
+  // Pops compare more queues and keep them for several pops.
+  MultiQueueParams::popChoices() = 4;
+  MultiQueueParams::popStickiness() = 3;
+  MultiQueueParams::prefetchChoices() = true;
+  ok &= check(all, 1000);
+  MultiQueueParams::popChoices() = 2;
+  MultiQueueParams::popStickiness() = 1;
+  MultiQueueParams::prefetchChoices() = false;
+  ok &= checkBoundedDelay();
+  ok &= checkResize(1000);
+  ok &= checkDeferredPush();
+  ok &= checkLongDeferredPush(100);
+  Galois::setActiveThreads(4);
+  ok &= checkConcurrentDeferredPush(100000);
+  ok &= checkConcurrentResize(10000);
+  ok &= checkFloatPriorities(1000);
+  ok &= checkWidePriorities(1000);
+  ok &= checkLexicographicKeys();
+  ok &= checkHighLexicographicKeys(1000);
+
+  std::cout << (ok ? "OK" : "FAILED") << "\n";
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,253 @@
+#include "Galois/Galois.h"
+#include "Galois/WorkList/StealingMultiQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace Galois::WorkList;
+
+//! Element with a priority, several elements share it.
+struct Prioritized {
+  unsigned long id;
+
+  unsigned long prior() const {
+    return id / 3;
+  }
+
+  operator unsigned long() const {
+    return id;
+  }
+};
+
+struct PriorComparer {
+  bool operator()(Prioritized const& a, Prioritized const& b) const {
+    return a.prior() > b.prior();
+  }
+};
+
+//! Request to update a node, stale if the node has a better one.
+struct NodeRequest {
+  unsigned long node;
+  unsigned long w;
+
+  bool operator==(NodeRequest const& other) const {
+    return node == other.node && w == other.w;
+  }
+};
+
+struct NodeRequestComparer {
+  bool operator()(NodeRequest const& a, NodeRequest const& b) const {
+    return a.w > b.w;
+  }
+};
+
+//! Heap and position of the request of every node.
+struct NodeIndexer {
+  static std::vector<std::pair<int, uint32_t>>& pairs() {
+    static std::vector<std::pair<int, uint32_t>> value(100, {-1, 0});
+    return value;
+  }
+
+  static void set_pair(NodeRequest const& r, int q, uint32_t ind) {
+    pairs()[r.node] = {q, ind};
+  }
+
+  static std::pair<int, uint32_t> get_pair(NodeRequest const& r) {
+    return pairs()[r.node];
+  }
+};
+
+//! Pushes improving requests for the same nodes, only the tracked ones
+//! are decreased, so that less than a request per push is popped.
+bool checkDecreaseKey(size_t rounds) {
+  const unsigned long nodes = NodeIndexer::pairs().size();
+  DecreaseKeyStealingMultiQueue<NodeRequest, NodeRequestComparer, NodeIndexer> wl(1);
+  for (size_t r = 0; r < rounds; r++) {
+    std::vector<NodeRequest> requests;
+    for (unsigned long n = 0; n < nodes; n++)
+      requests.push_back({n, 1000 - r * 100 + n});
+    wl.push(0, requests.begin(), requests.end());
+  }
+  std::vector<unsigned long> best(nodes, ~0ul);
+  size_t popped = 0;
+  while (auto val = wl.pop(0)) {
+    popped++;
+    best[val->node] = std::min(best[val->node], val->w);
+  }
+  for (unsigned long n = 0; n < nodes; n++) {
+    if (best[n] != 1000 - (rounds - 1) * 100 + n) {
+      std::cerr << "lost request of " << n << "\n";
+      return false;
+    }
+  }
+  if (popped >= nodes * rounds) {
+    std::cerr << "no keys decreased\n";
+    return false;
+  }
+  return true;
+}
+
+//! Pushes elements from the first queue, pops them alternating
+//! between the queues and checks that every element is returned once.
+template<typename WL>
+bool check(WL& wl, size_t nQ, size_t num) {
+  std::vector<typename WL::value_type> elements;
+  for (unsigned long i = 0; i < num; ++i)
+    elements.push_back({(i * 7919) % num});
+  // The first batch is merged into the empty heap, the others are smaller
+  // than the heap.
+  wl.push(0, elements.begin(), elements.begin() + num / 2);
+  wl.push(0, elements.begin() + num / 2, elements.begin() + num * 3 / 4);
+  wl.push(0, elements.begin() + num * 3 / 4, elements.end());
+
+  std::vector<int> seen(num, 0);
+  size_t emptyInRow = 0;
+  for (size_t i = 0; emptyInRow < nQ; i = (i + 1) % nQ) {
+    auto val = wl.pop(i);
+    if (!val) {
+      emptyInRow++;
+      continue;
+    }
+    emptyInRow = 0;
+    if (*val >= num || seen[*val]++) {
+      std::cerr << "unexpected element " << *val << "\n";
+      return false;
+    }
+  }
+  for (size_t i = 0; i < num; ++i) {
+    if (!seen[i]) {
+      std::cerr << "lost element " << i << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+//! Checks that a single queue pops the elements by priorities.
+template<typename WL>
+bool checkOrder(WL& wl, size_t num) {
+  std::vector<Prioritized> elements;
+  for (unsigned long i = 0; i < num; ++i)
+    elements.push_back({(i * 7919) % num});
+  wl.push(0, elements.begin(), elements.begin() + num / 2);
+  wl.push(0, elements.begin() + num / 2, elements.end());
+  unsigned long last = 0;
+  while (auto val = wl.pop(0)) {
+    if (val->prior() < last) {
+      std::cerr << "wrong order " << val->id << "\n";
+      return false;
+    }
+    last = val->prior();
+  }
+  return true;
+}
+
+//! The first thread pushes batches and pops, while the others steal slices
+//! of its buffer, which are smaller than the batch. Checks that every
+//! element is returned once.
+bool checkConcurrentSliceSteal(size_t num) {
+  const size_t threads = Galois::getActiveThreads();
+  StealingMultiQueueParams::stealProb() = 1;
+  StealingMultiQueueParams::stealBatchSize() = 8;
+  StealingMultiQueueParams::stealSliceSize() = 1;
+  RuntimeStealingMultiQueue<unsigned long, std::greater<unsigned long>> wl(threads);
+  StealingMultiQueueParams::stealSliceSize() = 0;
+
+  std::unique_ptr<std::atomic<int>[]> seen(new std::atomic<int>[num]());
+  std::atomic<size_t> popped{0};
+  std::atomic<bool> pushed{false};
+  std::atomic<bool> unexpected{false};
+  auto run = [&](size_t tId) {
+    unsigned long next = 0;
+    std::vector<unsigned long> batch;
+    // Gives up, if the elements are lost.
+    for (size_t misses = 0; popped.load() < num && misses < 100000;) {
+      if (tId == 0 && next < num) {
+        batch.clear();
+        for (; batch.size() < 16 && next < num; next++)
+          batch.push_back(next);
+        wl.push(0, batch.begin(), batch.end());
+        if (next == num)
+          pushed = true;
+      }
+      auto val = wl.pop(tId);
+      if (!val) {
+        if (pushed.load())
+          misses++;
+        else
+          std::this_thread::yield();
+        continue;
+      }
+      misses = 0;
+      if (*val >= num || seen[*val]++)
+        unexpected = true;
+      popped++;
+    }
+  };
+  Galois::on_each([&](unsigned tid, unsigned) { run(tid); });
+
+  if (unexpected) {
+    std::cerr << "unexpected element stolen\n";
+    return false;
+  }
+  for (size_t i = 0; i < num; ++i) {
+    if (!seen[i]) {
+      std::cerr << "lost element " << i << " of a partially stolen buffer\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  typedef std::greater<unsigned long> Comparer;
+  bool ok = true;
+
+  StealingMultiQueue<unsigned long, Comparer, 2, 4> smq(3);
+  ok &= check(smq, 3, 1000);
+
+  StealingMultiQueueParams::stealProb() = 1;
+  StealingMultiQueueParams::stealBatchSize() = 3;
+  RuntimeStealingMultiQueue<unsigned long, Comparer> rsmq(3);
+  ok &= check(rsmq, 3, 1000);
+
+  StealingMultiQueueParams::stealProb() = 6;
+  StealingMultiQueueParams::stealBatchSize() = 1;
+  RuntimeStealingMultiQueue<unsigned long, Comparer> rsmq2(2);
+  ok &= check(rsmq2, 2, 1000);
+
+  StealingMultiQueueParams::stealProb() = 1;
+  StealingMultiQueueParams::stealBatchSize() = 8;
+  StealingMultiQueueParams::stealSliceSize() = 3;
+  RuntimeStealingMultiQueue<unsigned long, Comparer> rsmq3(4);
+  ok &= check(rsmq3, 4, 1000);
+
+  StealingMultiQueueParams::stealSliceSize() = 0;
+  PackedStealingMultiQueue<Prioritized, PriorComparer> psmq(3);
+  ok &= check(psmq, 3, 1000);
+
+  PackedStealingMultiQueue<Prioritized, PriorComparer, uint32_t, 16> psmq16(3);
+  ok &= check(psmq16, 3, 1000);
+
+  // A single queue pops in the order of priorities.
+  PackedStealingMultiQueue<Prioritized, PriorComparer> psmq1(1);
+  ok &= checkOrder(psmq1, 1000);
+  PackedStealingMultiQueue<Prioritized, PriorComparer, uint32_t, 8> psmq2(1);
+  ok &= checkOrder(psmq2, 1000);
+  PackedStealingMultiQueue<Prioritized, PriorComparer, uint64_t, 16> psmq3(1);
+  ok &= checkOrder(psmq3, 1000);
+
+  ok &= checkDecreaseKey(5);
+  Galois::setActiveThreads(4);
+  ok &= checkConcurrentSliceSteal(200000);
+
+  std::cout << (ok ? "OK" : "FAILED") << "\n";
+  return ok ? 0 : 1;
+}
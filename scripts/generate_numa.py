@@ -4,6 +4,8 @@ import sys
 import csv
 import os
 
+from policymq_flags import is_policymq, flags_by_name
+
 
 def find_avg_for_each(file):
     name_to_sum_qnty = {}
@@ -39,14 +41,6 @@ for algo in ['boruvka', 'astar']:
     for graph in ['usa', 'west']:
         algo_graph.append((algo, graph))
 
-mq2typedef = {
-    'mqpp': 'ProbProb',
-    'mqpl': 'ProbLocal',
-    'mqlp': 'LocalProb',
-    'mqll': 'LocalLocal',
-}
-
-
 numa_ws = [1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024]
 
 def declaration_by_name(name):
@@ -57,8 +51,9 @@ def declaration_by_name(name):
         line = f'typedef StealingMultiQueue<UpdateRequest, Comparer, {splitn[1]}, {splitn[2]}> {name};'
     elif pref.startswith('slsmq'):
         line = f'typedef SkipListSMQ<UpdateRequest, Comparer, {splitn[1]}, {splitn[2]}, {w}> {wl_name};'
-    elif pref in mq2typedef:
-        line = f'typedef MultiQueue{mq2typedef[pref]}<UpdateRequest, Comparer, {splitn[2]}, {splitn[3]}, {splitn[1]}> {name};'
+    elif is_policymq(name):
+        # Selected by the command line flags of "policymq"
+        return ''
     else:
         raise f'Invalid prefix: {name}'
     line += f'\nif (wl == \"{name}\") RUN_WL({name});\n'
@@ -75,9 +70,9 @@ def numa_declaration_by_name(name, w):
         line = f'typedef StealingMultiQueueNuma<UpdateRequest, Comparer, {splitn[1]}, {splitn[2]}, {w}> {wl_name};'
     elif pref == 'slsmqhm':
         line = f'typedef SkipListSMQNuma<UpdateRequest, Comparer, {splitn[1]}, {splitn[2]}, {w}> {wl_name};'
-    elif pref in mq2typedef:
-        line = f'typedef MultiQueue{mq2typedef[pref]}Numa<UpdateRequest, Comparer, {splitn[2]}, {splitn[3]}, ' \
-           f'{splitn[1]}, {w}> {wl_name};'
+    elif is_policymq(name):
+        # Selected by the command line flags of "policymqnuma"
+        return ''
     else:
         raise f'Invalid prefix: {name}'
     line += f'\nif (wl == \"{wl_name}\") RUN_WL({wl_name});\n'
@@ -112,7 +107,8 @@ def generate_best():
     script = open(f'run_best.sh', 'w')  # TODO w or a
     for (algo, graph, name) in algo2best:
         res_suff = f'{wl}_best' # TODO with wl or without
-        script.write(f'$MQ_ROOT/scripts/run_wl_n_times.sh {algo} {graph} {name} $threads $times {res_suff}\n')
+        flags = flags_by_name(name)
+        script.write(f'$MQ_ROOT/scripts/run_wl_n_times.sh {algo} {graph} {flags[0]} $threads $times {res_suff} {" ".join(flags[1:])}\n')
     script.close()
 
 
@@ -145,7 +141,8 @@ def generate_best_numa():
             splitn.append(str(w))
             numa_name = '_'.join(splitn)
             res_suff = f'{wl}_numa' # TODO with wl or without
-            script.write(f'$MQ_ROOT/scripts/run_wl_n_times.sh {algo} {graph} {numa_name} $HM_THREADS $HM_RUNS {res_suff}\n')
+            flags = flags_by_name(numa_name)
+            script.write(f'$MQ_ROOT/scripts/run_wl_n_times.sh {algo} {graph} {flags[0]} $HM_THREADS $HM_RUNS {res_suff} {" ".join(flags[1:])}\n')
     script.close()
 
 generate_best_numa()
@@ -12,34 +12,25 @@ clear_file () {
 
 mq=$1
 C=$MQ_C
-mq_c="${mq}_$C"
 
-mq_name="Killme"
-if [ $mq == "mqpp" ]; then
-    mq_name="ProbProb"
-  elif [ $mq == "mqpl" ]; then
-    mq_name="ProbLocal"
+# Prob -- temporal locality, Local -- task batching.
+insert="temporal"
+delete="temporal"
+if [ $mq == "mqpl" ]; then
+    delete="batching"
   elif [ $mq == "mqlp" ]; then
-    mq_name="LocalProb"
+    insert="batching"
   elif [ $mq == "mqll" ]; then
-    mq_name="LocalLocal"
+    insert="batching"
+    delete="batching"
 fi
 
-generate_heatmaps () {
-  for p in "${HM_FST[@]}"
-  do
-    for ss in "${HM_SND[@]}"
-      do
-        name="${mq_c}_${p}_${ss}"
-        echo "typedef MultiQueue${mq_name}<UpdateRequest, Comparer, $p, $ss, $C> $name;" >> $1
-        echo "if (wl == \"$name\") RUN_WL($name);" >> $1
-      done
-  done
-}
-
+# The "policymq" worklist takes its policies from the command line, so a
+# single binary covers the whole heatmap.
 run_wl_n_times() {
   for run in $(seq 1 $2); do
-    $MQ_ROOT/scripts/single_run/run_${algo}_${graph}.sh $1 $threads $3
+    $MQ_ROOT/scripts/single_run/run_${algo}_${graph}.sh $1 $threads $3 \
+      -mqC $C -mqInsert $insert -mqInsertParam $4 -mqDelete $delete -mqDeleteParam $5
   done
 }
 
@@ -61,7 +52,6 @@ fi
 if [ $action == "build" ]; then
   file="$GALOIS_HOME/apps/${algo}/Experiments.h"
   clear_file $file
-  generate_heatmaps $file
   $MQ_ROOT/scripts/build/build_${algo}.sh
 elif [ $action == "run" ]; then
   graph=$4
@@ -69,8 +59,7 @@ elif [ $action == "run" ]; then
   runs=$HM_RUNS
   for p in "${HM_FST[@]}"; do
     for ss in "${HM_SND[@]}"; do
-        name="${mq_c}_${p}_${ss}"
-        run_wl_n_times $name $runs "${algo}_${graph}_${mq}_$threads"
+        run_wl_n_times policymq $runs "${algo}_${graph}_${mq}_$threads" $p $ss
     done
   done
 fi
@@ -0,0 +1,38 @@
+# Translates a PolicyMultiQueue experiment name into the worklist and its
+# command line flags, e.g. mqpl_4_8_16 -> policymq -mqC 4 -mqInsert temporal
+# -mqInsertParam 8 -mqDelete batching -mqDeleteParam 16. Other names are
+# printed unchanged.
+
+import sys
+
+# Letters of the policies in the names: r -- random or two-choice,
+# p -- temporal locality, l -- task batching.
+insert_policy = {'r': 'random', 'p': 'temporal', 'l': 'batching'}
+delete_policy = {'r': 'choice', 'p': 'temporal', 'l': 'batching'}
+
+
+def is_policymq(name):
+    pref = name.split('_')[0]
+    if pref.endswith('numa'):
+        pref = pref[:-len('numa')]
+    return len(pref) == 4 and pref.startswith('mq') \
+        and pref[2] in insert_policy and pref[3] in delete_policy
+
+
+def flags_by_name(name):
+    if not is_policymq(name):
+        return [name]
+    splitn = name.split('_')
+    pref = splitn[0]
+    numa = pref.endswith('numa')
+    flags = ['policymqnuma' if numa else 'policymq',
+             '-mqC', splitn[1],
+             '-mqInsert', insert_policy[pref[2]], '-mqInsertParam', splitn[2],
+             '-mqDelete', delete_policy[pref[3]], '-mqDeleteParam', splitn[3]]
+    if numa:
+        flags += ['-numaWeight', splitn[4]]
+    return flags
+
+
+if __name__ == '__main__':
+    print(' '.join(flags_by_name(sys.argv[1])))
@@ -63,16 +63,12 @@ $MQ_ROOT/scripts/run_wl_all_algo.sh "hmq$MQ_C" 1 $HM_RUNS "base_1"
 
 ################## NUMA ##################
 
-if [[ "$NUMA_NODES" == "2" || "$NUMA_NODES" == "4" ]]; then
-  echo "Vary NUMA weights for best heatmap combinations"
-  $MQ_ROOT/scripts/run_best_numa.sh smq
-  $MQ_ROOT/scripts/run_best_numa.sh mqpp
-  $MQ_ROOT/scripts/run_best_numa.sh mqpl
-  $MQ_ROOT/scripts/run_best_numa.sh mqlp
-  $MQ_ROOT/scripts/run_best_numa.sh mqll
-else
-  echo "NUMA execution for $NUMA_NODES nodes not supported"
-fi
+echo "Vary NUMA weights for best heatmap combinations"
+$MQ_ROOT/scripts/run_best_numa.sh smq
+$MQ_ROOT/scripts/run_best_numa.sh mqpp
+$MQ_ROOT/scripts/run_best_numa.sh mqpl
+$MQ_ROOT/scripts/run_best_numa.sh mqlp
+$MQ_ROOT/scripts/run_best_numa.sh mqll
 
 ################## PLOTS ##################
 # Running best worklists on different amount of threads (specified in PLT_THREADS).
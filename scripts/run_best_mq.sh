@@ -5,6 +5,8 @@ source $MQ_ROOT/set_envs.sh
 t=$HM_THREADS
 times=$PLT_RUNS
 pyscript=$MQ_ROOT/scripts/find_best_wl.py
+# The best heatmap name, e.g. mqpl_4_8_16, is run as policymq with its flags
+flags_script=$MQ_ROOT/scripts/policymq_flags.py
 for mq in mqpp mqpl mqlp mqll; do
 #  dir=''
 #  if [ $mq == "mqpp" ]; then
@@ -30,7 +32,8 @@ for mq in mqpp mqpl mqlp mqll; do
         echo ">>>>"
         echo "$algo $graph"
         wl_name=$( $PYTHON_EXPERIMENTS $pyscript "$hm_path/${algo}_${graph}_${mq}_$t" )
-        $MQ_ROOT/scripts/run_wl_n_times_all_threads.sh $algo $graph $wl_name $times $mq
+        wl_flags=( $( $PYTHON_EXPERIMENTS $flags_script $wl_name ) )
+        $MQ_ROOT/scripts/run_wl_n_times_all_threads.sh $algo $graph ${wl_flags[0]} $times $mq "${wl_flags[@]:1}"
     done
   done
   for algo in boruvka astar; do
@@ -38,7 +41,8 @@ for mq in mqpp mqpl mqlp mqll; do
         echo ">>>>"
         echo "$algo $graph"
         wl_name=$( $PYTHON_EXPERIMENTS $pyscript "$hm_path/${algo}_${graph}_${mq}_$t" )
-        $MQ_ROOT/scripts/run_wl_n_times_all_threads.sh $algo $graph $wl_name $times $mq
+        wl_flags=( $( $PYTHON_EXPERIMENTS $flags_script $wl_name ) )
+        $MQ_ROOT/scripts/run_wl_n_times_all_threads.sh $algo $graph ${wl_flags[0]} $times $mq "${wl_flags[@]:1}"
     done
   done
 done
\ No newline at end of file
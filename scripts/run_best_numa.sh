@@ -3,10 +3,7 @@
 source $MQ_ROOT/set_envs.sh
 
 
-# Save NUMA-related configuration.
-echo "#define SOCKETS_NUM $NUMA_NODES" > $GALOIS_HOME/include/Galois/WorkList/MQOptimized/SOCKETS_NUM.h
-echo "#define SOCKET_SIZE $SOCKET_SIZE" > $GALOIS_HOME/include/Galois/WorkList/MQOptimized/SOCKET_SIZE.h
-
+# The NUMA layout is taken from the HW topology at runtime.
 
 wl=$1
 echo "Running best numa for wl $wl"
@@ -22,13 +19,15 @@ cd $plt_dir/${wl}_plots
 for algo in sssp bfs; do
   for graph in usa twi web west; do
     wl_name=$( $PYTHON_EXPERIMENTS $MQ_ROOT/scripts/find_best_wl.py "${numa_path}/${algo}_${graph}_${wl}_numa" )
-    $MQ_ROOT/scripts/run_wl_n_times_all_threads.sh $algo $graph $wl_name $PLT_RUNS  "${wl}_numa"
+    wl_flags=( $( $PYTHON_EXPERIMENTS $MQ_ROOT/scripts/policymq_flags.py $wl_name ) )
+    $MQ_ROOT/scripts/run_wl_n_times_all_threads.sh $algo $graph ${wl_flags[0]} $PLT_RUNS  "${wl}_numa" "${wl_flags[@]:1}"
   done
 done
 
 for algo in astar boruvka; do
   for graph in usa west; do
     wl_name=$( $PYTHON_EXPERIMENTS $MQ_ROOT/scripts/find_best_wl.py "${numa_path}/${algo}_${graph}_${wl}_numa" )
-    $MQ_ROOT/scripts/run_wl_n_times_all_threads.sh $algo $graph $wl_name $PLT_RUNS  "${wl}_numa"
+    wl_flags=( $( $PYTHON_EXPERIMENTS $MQ_ROOT/scripts/policymq_flags.py $wl_name ) )
+    $MQ_ROOT/scripts/run_wl_n_times_all_threads.sh $algo $graph ${wl_flags[0]} $PLT_RUNS  "${wl}_numa" "${wl_flags[@]:1}"
   done
 done
\ No newline at end of file
@@ -4,9 +4,10 @@ wl=$3
 threads=$4
 times=$([ -z $5 ] && echo 5 || echo $5)
 result=$([ -z $6 ] && echo "${algo}_${graph}" || echo "${algo}_${graph}_$6")
+# The remaining arguments are passed to the worklist
 
 $MQ_ROOT/scripts/build/build.sh $algo
 
 for i in $(seq 1 $times); do
-  $MQ_ROOT/scripts/single_run/run_${algo}_${graph}.sh $wl $threads $result
+  $MQ_ROOT/scripts/single_run/run_${algo}_${graph}.sh $wl $threads $result "${@:7}"
 done
@@ -18,4 +18,4 @@ pagerank=$GALOIS_HOME/build/apps/pagerank/pagerank
  
 algo=bfs
 graph=lj
-${!algo} ${!graph} -wl $1 -t $2 -resultFile $3 -delta 0
+${!algo} ${!graph} -wl $1 -t $2 -resultFile $3 -delta 0 "${@:4}"
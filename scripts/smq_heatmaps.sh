@@ -11,21 +11,11 @@ clear_file () {
   echo "" > $1
 }
 
-generate_heatmaps () {
-  for p in "${PROBS[@]}"
-  do
-    for ss in "${STEAL_SIZES[@]}"
-      do
-        name="smqhm_${p}_${ss}"
-        echo "typedef StealingMultiQueue<UpdateRequest, Comparer, $p, $ss> $name;" >> $1
-        echo "if (wl == \"$name\") RUN_WL($name);" >> $1
-      done
-  done
-}
-
+# The "smq" worklist takes the steal probability and the steal batch size
+# from the command line, so a single binary covers the whole heatmap.
 run_wl_n_times() {
   for run in $(seq 1 $2); do
-    $MQ_ROOT/scripts/single_run/run_${algo}_${graph}.sh $1 $threads $3
+    $MQ_ROOT/scripts/single_run/run_${algo}_${graph}.sh $1 $threads $3 -stealProb $4 -stealBatch $5
   done
 }
 
@@ -48,7 +38,6 @@ fi
 if [ $action == "build" ]; then
   file="$GALOIS_HOME/apps/${algo}/Experiments.h"
   clear_file $file
-  generate_heatmaps $file
   $MQ_ROOT/scripts/build/build_${algo}.sh
 elif [ $action == "run" ]; then
   graph=$3
@@ -56,7 +45,7 @@ elif [ $action == "run" ]; then
   runs=$HM_RUNS
   for p in "${PROBS[@]}"; do
     for ss in "${STEAL_SIZES[@]}"; do
-        run_wl_n_times "smqhm_${p}_${ss}" $runs "${algo}_${graph}_smq_$threads"
+        run_wl_n_times smq $runs "${algo}_${graph}_smq_$threads" $p $ss
     done
   done
 fi
@@ -11,11 +11,6 @@ export CPU=intel
 # update HM_THREADS below.
 export MAX_CPU_NUM=128
 
-# Number of NUMA nodes.
-# Used *only* for SMQ & MQ Opitimized NUMA experiments.
-# Currently, only 2 and 4 nodes are supported for the experiments.
-export NUMA_NODES=2
-
 # The version of python to use for scripts.
 export PYTHON_EXPERIMENTS=python3.8
 
@@ -31,9 +26,6 @@ export GALOIS_HOME=$MQ_ROOT/Galois-2.2.1/
 # C parameter for MQ. Number of queue = C x #threads.
 export MQ_C=4
 
-# Number of CPUs per NUMA socket.
-export SOCKET_SIZE=$(( $MAX_CPU_NUM / $NUMA_NODES ))
-
 ######### HEATMAPS #########
 
 # Number of threads to count heatmaps.